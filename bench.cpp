@@ -0,0 +1,374 @@
+// мікробенчмарки та навантажувальні тести Channel, Scheduler і ThreadPool
+//
+// збирання (так само, як main.cpp, окремої системи збирання немає):
+//     g++ -std=c++17 -O2 -pthread bench.cpp -o bench
+// запуск:
+//     ./bench                  — усі бенчмарки, результат у JSON
+//     ./bench --csv            — результат у CSV
+//     ./bench --quick          — зменшені розміри (для швидкої перевірки)
+//     ./bench --filter=channel — лише бенчмарки, назва яких містить підрядок
+//     ./bench --trace=out.json — додатково записати трасу подій пулу (див. trace.hpp)
+//
+// кожен рядок результату містить назву бенчмарку, бекенд і параметри, тож прогони різних версій
+// можна порівнювати між собою; новий бекенд каналу достатньо додати до CHANNEL_BACKENDS,
+// а нову конфігурацію пулу — до pool_configs(), щоб він вимірювався поруч із базовим mutex+deque
+// діагностичний вивід пулу й планувальника в std::cout під час вимірювань вимикається
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "channel.hpp"
+#include "histogram.hpp"
+#include "scheduler.hpp"
+#include "threadpool.hpp"
+#include "trace.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+// один рядок результату
+struct BenchResult {
+    std::string name;
+    std::string backend;
+    std::string params;
+    uint64_t ops = 0;
+    double seconds = 0;
+    LatencySnapshot latency; // порожнє, якщо бенчмарк не вимірює затримку
+};
+
+struct BenchConfig {
+    bool csv = false;
+    bool quick = false;
+    std::string filter;
+    std::string trace_path;
+};
+
+static const ChannelBackend CHANNEL_BACKENDS[] = {ChannelBackend::Mutex, ChannelBackend::LockFreeRing};
+
+static const char* backend_name(ChannelBackend backend) {
+    switch (backend) {
+        case ChannelBackend::Mutex: return "mutex";
+        case ChannelBackend::LockFreeRing: return "ring";
+    }
+    return "unknown";
+}
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now().time_since_epoch()).count();
+}
+
+static double seconds_since(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+// вимикає std::cout на час існування об'єкта (пул друкує про зупинку робітників і статистику)
+class QuietCout {
+public:
+    QuietCout()
+        : saved(std::cout.rdbuf(nullptr))
+    {
+    }
+
+    ~QuietCout() {
+        std::cout.rdbuf(saved);
+        std::cout.clear();
+    }
+
+private:
+    std::streambuf* saved;
+};
+
+// Channel: пропускна здатність і затримка send -> receive для producers відправників
+// і consumers отримувачів; кожне повідомлення — час відправки в наносекундах, 0 — сигнал кінця
+static BenchResult bench_channel(ChannelBackend backend, size_t producers, size_t consumers, uint64_t messages) {
+    Channel<uint64_t> channel(backend);
+    std::vector<std::unique_ptr<LatencyHistogram>> latencies;
+    for (size_t i = 0; i < consumers; ++i)
+        latencies.emplace_back(new LatencyHistogram());
+
+    uint64_t per_producer = messages / producers;
+    std::vector<std::thread> threads;
+    auto start = bench_clock::now();
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&channel, &latencies, c]() {
+            LatencyHistogram& hist = *latencies[c];
+            while (true) {
+                uint64_t sent = channel.receive();
+                if (sent == 0)
+                    return;
+                hist.record(now_ns() - sent);
+            }
+        });
+    }
+    std::vector<std::thread> senders;
+    for (size_t p = 0; p < producers; ++p) {
+        senders.emplace_back([&channel, per_producer]() {
+            for (uint64_t i = 0; i < per_producer; ++i)
+                channel.send(now_ns());
+        });
+    }
+    for (auto &t : senders)
+        t.join();
+    for (size_t c = 0; c < consumers; ++c)
+        channel.send(uint64_t(0));
+    for (auto &t : threads)
+        t.join();
+
+    BenchResult result;
+    result.name = "channel_send_receive";
+    result.backend = backend_name(backend);
+    result.params = "producers=" + std::to_string(producers) + ";consumers=" + std::to_string(consumers);
+    result.ops = per_producer * producers;
+    result.seconds = seconds_since(start);
+    std::vector<const LatencyHistogram*> parts;
+    for (auto &hist : latencies)
+        parts.push_back(hist.get());
+    result.latency = LatencyHistogram::merge(parts.begin(), parts.end());
+    return result;
+}
+
+// Scheduler: вартість schedule() і run() на одне завдання (без виконання завдань)
+static std::vector<BenchResult> bench_scheduler(ChannelBackend backend, uint64_t jobs) {
+    auto channel = std::make_shared<Channel<Job>>(backend, static_cast<size_t>(jobs));
+    Scheduler scheduler(channel);
+
+    auto start = bench_clock::now();
+    for (uint64_t i = 0; i < jobs; ++i)
+        scheduler.schedule(Job([]() {}));
+    double schedule_seconds = seconds_since(start);
+
+    start = bench_clock::now();
+    scheduler.run();
+    double run_seconds = seconds_since(start);
+
+    Job job;
+    while (channel->try_receive(job)) {
+    }
+
+    std::vector<BenchResult> results(2);
+    results[0].name = "scheduler_schedule";
+    results[1].name = "scheduler_run";
+    results[0].seconds = schedule_seconds;
+    results[1].seconds = run_seconds;
+    for (auto &r : results) {
+        r.backend = backend_name(backend);
+        r.params = "jobs=" + std::to_string(jobs);
+        r.ops = jobs;
+    }
+    return results;
+}
+
+struct PoolConfig {
+    std::string name;
+    ThreadPoolOptions options;
+};
+
+// процесори поточної машини, поділені навпіл між двома штучними вузлами NUMA
+// (з одним процесором обидва вузли отримують той самий)
+static CpuTopology synthetic_two_nodes() {
+    std::vector<int> cpus;
+    for (auto &node : CpuTopology::detect().nodes)
+        cpus.insert(cpus.end(), node.begin(), node.end());
+    size_t half = std::max<size_t>(1, cpus.size() / 2);
+    std::vector<int> first(cpus.begin(), cpus.begin() + half);
+    std::vector<int> second(cpus.begin() + std::min(half, cpus.size() - 1), cpus.end());
+    return CpuTopology({first, second});
+}
+
+// конфігурації пулу для порівняння; базова — SharedQueue з каналом mutex+deque
+// кожна вимірюється в подієвому режимі та в пакетному (суфікс +batch, пакети без паузи між ними)
+static std::vector<PoolConfig> pool_configs() {
+    std::vector<PoolConfig> configs;
+    for (auto dispatch : {DispatchMode::EventDriven, DispatchMode::Batch}) {
+        for (auto backend : CHANNEL_BACKENDS) {
+            for (auto mode : {ExecutionMode::SharedQueue, ExecutionMode::WorkStealing}) {
+                PoolConfig config;
+                config.options.dispatch_mode = dispatch;
+                config.options.channel_backend = backend;
+                config.options.execution_mode = mode;
+                config.name = std::string(backend_name(backend)) + (mode == ExecutionMode::WorkStealing ? "+stealing" : "+shared");
+                if (dispatch == DispatchMode::Batch)
+                    config.name += "+batch";
+                configs.push_back(config);
+            }
+        }
+    }
+    // розміщення Scatter на штучній топології з двох вузлів: канал на вузол і забирання з чужого
+    // каналу перевіряються й на машині з одним вузлом NUMA
+    for (auto mode : {ExecutionMode::SharedQueue, ExecutionMode::WorkStealing}) {
+        PoolConfig config;
+        config.options.dispatch_mode = DispatchMode::EventDriven;
+        config.options.execution_mode = mode;
+        config.options.placement = Placement::Scatter;
+        config.options.topology = synthetic_two_nodes();
+        config.name = std::string("mutex") + (mode == ExecutionMode::WorkStealing ? "+stealing" : "+shared") + "+2nodes";
+        configs.push_back(config);
+    }
+    return configs;
+}
+
+// дрібна обчислювальна робота для CPU-bound завдань
+static void spin_work(unsigned iterations) {
+    volatile uint64_t x = 1;
+    for (unsigned i = 0; i < iterations; ++i)
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+}
+
+// ThreadPool: пропускна здатність для jobs завдань по work ітерацій (0 — порожні завдання)
+// вимірюється весь шлях: execute() з потоку викликача, планувальник, канал, виконання
+static BenchResult bench_pool_throughput(const PoolConfig& config, size_t workers, uint64_t jobs, unsigned work) {
+    std::atomic<uint64_t> done{0};
+    bench_clock::time_point start;
+    double seconds;
+    {
+        QuietCout quiet;
+        ThreadPool pool(workers, std::chrono::seconds(0), config.options);
+        start = bench_clock::now();
+        for (uint64_t i = 0; i < jobs; ++i) {
+            pool.execute([&done, work]() {
+                if (work)
+                    spin_work(work);
+                done.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        while (done.load(std::memory_order_relaxed) < jobs)
+            std::this_thread::yield();
+        seconds = seconds_since(start);
+        pool.join();
+    }
+
+    BenchResult result;
+    result.name = work ? "pool_throughput_cpu" : "pool_throughput_empty";
+    result.backend = config.name;
+    result.params = "workers=" + std::to_string(workers) + ";work=" + std::to_string(work);
+    result.ops = jobs;
+    result.seconds = seconds;
+    return result;
+}
+
+// ThreadPool: затримка від execute() до початку виконання за помірного навантаження
+// (завдання надходять з інтервалом gap); береться з гістограм queue_wait робітників
+static BenchResult bench_pool_latency(const PoolConfig& config, size_t workers, uint64_t jobs, std::chrono::microseconds gap) {
+    std::atomic<uint64_t> done{0};
+    BenchResult result;
+    auto start = bench_clock::now();
+    {
+        QuietCout quiet;
+        ThreadPool pool(workers, std::chrono::seconds(0), config.options);
+        for (uint64_t i = 0; i < jobs; ++i) {
+            pool.execute([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+            auto next = bench_clock::now() + gap;
+            while (bench_clock::now() < next)
+                std::this_thread::yield();
+        }
+        while (done.load(std::memory_order_relaxed) < jobs)
+            std::this_thread::yield();
+        result.seconds = seconds_since(start);
+        result.latency = pool.latency_stats().queue_wait;
+        pool.join();
+    }
+
+    result.name = "pool_submit_to_start";
+    result.backend = config.name;
+    result.params = "workers=" + std::to_string(workers) + ";gap_us=" + std::to_string(gap.count());
+    result.ops = jobs;
+    return result;
+}
+
+static void print_json(const std::vector<BenchResult>& results) {
+    std::printf("[\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::printf("  {\"name\": \"%s\", \"backend\": \"%s\", \"params\": \"%s\", \"ops\": %llu, "
+                    "\"seconds\": %.6f, \"ops_per_sec\": %.1f, \"ns_per_op\": %.1f",
+                    r.name.c_str(), r.backend.c_str(), r.params.c_str(), static_cast<unsigned long long>(r.ops),
+                    r.seconds, r.seconds > 0 ? r.ops / r.seconds : 0.0, r.ops ? r.seconds * 1e9 / r.ops : 0.0);
+        if (r.latency.count > 0) {
+            std::printf(", \"latency_ns\": {\"count\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}",
+                        static_cast<unsigned long long>(r.latency.count), r.latency.mean,
+                        static_cast<unsigned long long>(r.latency.p50), static_cast<unsigned long long>(r.latency.p99),
+                        static_cast<unsigned long long>(r.latency.p999), static_cast<unsigned long long>(r.latency.max));
+        }
+        std::printf("}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+static void print_csv(const std::vector<BenchResult>& results) {
+    std::printf("name,backend,params,ops,seconds,ops_per_sec,ns_per_op,p50_ns,p99_ns,p999_ns,max_ns\n");
+    for (const auto &r : results) {
+        std::printf("%s,%s,%s,%llu,%.6f,%.1f,%.1f,%llu,%llu,%llu,%llu\n",
+                    r.name.c_str(), r.backend.c_str(), r.params.c_str(), static_cast<unsigned long long>(r.ops),
+                    r.seconds, r.seconds > 0 ? r.ops / r.seconds : 0.0, r.ops ? r.seconds * 1e9 / r.ops : 0.0,
+                    static_cast<unsigned long long>(r.latency.p50), static_cast<unsigned long long>(r.latency.p99),
+                    static_cast<unsigned long long>(r.latency.p999), static_cast<unsigned long long>(r.latency.max));
+    }
+}
+
+static bool selected(const BenchConfig& config, const char* name) {
+    return config.filter.empty() || std::string(name).find(config.filter) != std::string::npos;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--csv")
+            config.csv = true;
+        else if (arg == "--json")
+            config.csv = false;
+        else if (arg == "--quick")
+            config.quick = true;
+        else if (arg.compare(0, 9, "--filter=") == 0)
+            config.filter = arg.substr(9);
+        else if (arg.compare(0, 8, "--trace=") == 0)
+            config.trace_path = arg.substr(8);
+        else {
+            std::fprintf(stderr, "usage: %s [--json|--csv] [--quick] [--filter=substring] [--trace=file]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!config.trace_path.empty() && !trace::Tracer::instance().start(config.trace_path)) {
+        std::fprintf(stderr, "cannot start tracing to %s\n", config.trace_path.c_str());
+        return 1;
+    }
+
+    size_t cores = std::max(2u, std::thread::hardware_concurrency());
+    uint64_t scale = config.quick ? 10 : 1;
+    std::vector<BenchResult> results;
+
+    if (selected(config, "channel_send_receive")) {
+        for (auto backend : CHANNEL_BACKENDS)
+            for (size_t producers = 1; producers <= cores; producers *= 2)
+                for (size_t consumers = 1; consumers <= cores; consumers *= 2)
+                    results.push_back(bench_channel(backend, producers, consumers, 1000000 / scale));
+    }
+
+    if (selected(config, "scheduler")) {
+        for (auto backend : CHANNEL_BACKENDS)
+            for (auto &r : bench_scheduler(backend, 1000000 / scale))
+                results.push_back(r);
+    }
+
+    for (const auto &pool : pool_configs()) {
+        if (selected(config, "pool_throughput_empty"))
+            results.push_back(bench_pool_throughput(pool, cores, 1000000 / scale, 0));
+        if (selected(config, "pool_throughput_cpu"))
+            results.push_back(bench_pool_throughput(pool, cores, 100000 / scale, 2000));
+        if (selected(config, "pool_submit_to_start"))
+            results.push_back(bench_pool_latency(pool, cores, 20000 / scale, std::chrono::microseconds(20)));
+    }
+
+    trace::Tracer::instance().stop();
+    if (config.csv)
+        print_csv(results);
+    else
+        print_json(results);
+    return 0;
+}
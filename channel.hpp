@@ -1,56 +1,277 @@
 #ifndef CHANNEL_HPP
 #define CHANNEL_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <mutex>
-#include <condition_variable>
+#include "cpu.hpp"
+#include "event_count.hpp"
+#include "ring_buffer.hpp"
+
+// бекенд каналу: Mutex — std::deque під одним м'ютексом (необмежений, якщо не задано set_limit()),
+// LockFreeRing — обмежене lock-free кільце MPMC
+// обидва бекенди однаково чекають: отримувач спершу коротко крутиться (адаптивний спін),
+// потім паркується на eventcount; відправник будить лише тоді, коли хтось справді спить,
+// і робить це вже після звільнення м'ютекса, тож розбуджений потік не впирається в нього
+enum class ChannelBackend {
+    Mutex,
+    LockFreeRing
+};
+
+// місткість кільця за замовчуванням
+constexpr size_t DEFAULT_RING_CAPACITY = 1024;
 
 template <typename T>
 class Channel {
 public:
     Channel() = default;
 
+    // канал з обраним бекендом; capacity враховується лише для LockFreeRing
+    explicit Channel(ChannelBackend backend, size_t capacity = DEFAULT_RING_CAPACITY)
+        : backend(backend)
+    {
+        if (backend == ChannelBackend::LockFreeRing)
+            ring = std::make_unique<RingBuffer<T>>(capacity);
+    }
+
     // перевантаження send для lvalue
     void send(const T& t) {
-        std::unique_lock<std::mutex> lock(mtx);
-        queue.push_back(t);
-        cond.notify_one();
+        T copy(t);
+        send(std::move(copy));
+    }
+
+    // межа довжини черги бекенду Mutex (0 — без обмежень); повна черга, як і повне кільце,
+    // змушує відправника чекати на місце; задається до початку роботи з каналом
+    void set_limit(size_t max_len) {
+        std::lock_guard<std::mutex> lock(mtx);
+        limit = max_len;
+    }
+
+    // спільний eventcount кількох каналів: кожна відправка будить і його, тож отримувач, який
+    // чекає на будь-якому з цих каналів одразу (див. Worker::wait_any()), побачить нове завдання;
+    // задається до початку роботи з каналом
+    void set_wakeup(std::shared_ptr<EventCount> signal) {
+        wakeup = std::move(signal);
+    }
+
+    // чи може send() заблокуватися на повному каналі
+    bool is_bounded() const {
+        return ring || limit > 0;
     }
 
     // перевантаження send для rvalue
+    // для обмеженого каналу: якщо він повний, відправник чекає на вільне місце (backpressure)
     void send(T&& t) {
-        std::unique_lock<std::mutex> lock(mtx);
-        queue.push_back(std::move(t));
-        cond.notify_one();
+        if (is_bounded()) {
+            blocking_push(std::move(t));
+        } else {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue.push_back(std::move(t));
+            count.store(queue.size(), std::memory_order_relaxed);
+        }
+        wake_receivers(1);
+    }
+
+    // пакетна відправка: усі елементи [first, last) додаються під одним захопленням м'ютекса
+    // (або серією lock-free вставок у кільце), після чого будиться стільки отримувачів,
+    // скільки елементів надіслано, а не по одному сигналу на кожну вставку
+    // елементи конструюються з *first, тож для переміщення варто передавати std::move_iterator
+    template <typename It>
+    void send_bulk(It first, It last) {
+        size_t sent = 0;
+        if (is_bounded()) {
+            for (; first != last; ++first, ++sent) {
+                blocking_push(T(*first));
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (; first != last; ++first, ++sent) {
+                queue.push_back(T(*first));
+            }
+            count.store(queue.size(), std::memory_order_relaxed);
+        }
+        wake_receivers(sent);
+    }
+
+    // спроба відправити без блокування; повертає false, якщо канал повний (t не змінюється)
+    bool try_send(T&& t) {
+        if (is_bounded()) {
+            if (!try_push(t))
+                return false;
+            wake_receivers(1);
+            return true;
+        }
+        send(std::move(t));
+        return true;
+    }
+
+    bool try_send(const T& t) {
+        T copy(t);
+        return try_send(std::move(copy));
     }
 
     // метод отримання елемента з блокуванням, поки черга порожня
+    // спершу адаптивний спін, потім паркування на eventcount з повторною перевіркою
     T receive() {
-        std::unique_lock<std::mutex> lock(mtx);
-        while (queue.empty()) {
-            cond.wait(lock);
+        T val;
+        if (spin([&]() { return try_pop(val); }))
+            return val;
+        while (true) {
+            uint64_t ticket = readable.prepare_wait();
+            if (try_pop(val)) {
+                readable.cancel_wait();
+                return val;
+            }
+            readable.wait(ticket);
+            if (try_pop(val))
+                return val;
         }
-        T val = std::move(queue.front());
-        queue.pop_front();
-        return val;
+    }
+
+    // спроба отримати елемент без блокування; повертає false, якщо черга порожня
+    bool try_receive(T& out) {
+        return try_pop(out);
     }
 
     // метод перевірки, чи є черга порожньою
     bool is_empty() {
-        std::unique_lock<std::mutex> lock(mtx);
+        if (ring)
+            return ring->is_empty();
+        std::lock_guard<std::mutex> lock(mtx);
         return queue.empty();
     }
 
-    // метод отримання поточного розміру черги
+    // метод отримання поточного розміру черги (без блокування; може трохи відставати від відправників)
     size_t len() {
-        std::unique_lock<std::mutex> lock(mtx);
-        return queue.size();
+        if (ring)
+            return ring->size();
+        return count.load(std::memory_order_relaxed);
+    }
+
+    ChannelBackend get_backend() const {
+        return backend;
+    }
+
+    // скільки отримувачів зараз запарковано (або готуються заснути)
+    size_t idle_receivers() const {
+        return readable.num_waiters();
     }
 
 private:
+    // межі адаптивного спіну: ліміт зростає, коли спін закінчується успіхом,
+    // і зменшується вдвічі, коли потік однаково засинає
+    static constexpr unsigned MIN_SPIN = 16;
+    static constexpr unsigned MAX_SPIN = 1024;
+
+    ChannelBackend backend = ChannelBackend::Mutex;
+
     std::deque<T> queue;
+    size_t limit = 0; // межа довжини queue (0 — без обмежень)
     std::mutex mtx;
-    std::condition_variable cond;
+    // розмір queue, який читається без м'ютекса під час спіну
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> count{0};
+
+    std::unique_ptr<RingBuffer<T>> ring;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> spin_limit{64};
+    EventCount readable; // сплячі отримувачі
+    EventCount writable; // сплячі відправники (лише обмежений канал)
+    std::shared_ptr<EventCount> wakeup; // див. set_wakeup()
+
+    bool try_pop(T& out) {
+        if (ring) {
+            if (!ring->try_pop(out))
+                return false;
+            writable.notify_one();
+            return true;
+        }
+        // у бекенді Mutex порожню чергу видно без захоплення м'ютекса
+        if (count.load(std::memory_order_relaxed) == 0)
+            return false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (queue.empty())
+                return false;
+            out = std::move(queue.front());
+            queue.pop_front();
+            count.store(queue.size(), std::memory_order_relaxed);
+        }
+        if (limit > 0)
+            writable.notify_one();
+        return true;
+    }
+
+    // вставка в обмежений канал без очікування; false — канал повний (t не змінюється)
+    bool try_push(T& t) {
+        if (ring)
+            return ring->try_push(std::move(t));
+        std::lock_guard<std::mutex> lock(mtx);
+        if (queue.size() >= limit)
+            return false;
+        queue.push_back(std::move(t));
+        count.store(queue.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    // активне очікування до spin_limit ітерацій; ліміт підлаштовується під результат
+    template <typename Attempt>
+    bool spin(Attempt attempt) {
+        unsigned budget = spin_limit.load(std::memory_order_relaxed);
+        for (unsigned spins = 0; spins < budget; ++spins) {
+            if (attempt()) {
+                if (spins > 0 && budget < MAX_SPIN)
+                    spin_limit.store(budget + budget / 8 + 1, std::memory_order_relaxed);
+                return true;
+            }
+            spin_backoff(spins);
+        }
+        if (budget > MIN_SPIN)
+            spin_limit.store(budget / 2, std::memory_order_relaxed);
+        return false;
+    }
+
+    // вставка в обмежений канал без сигналу отримувачам (його подає викликач)
+    void blocking_push(T&& t) {
+        if (spin([&]() { return try_push(t); }))
+            return;
+
+        // канал залишається повним — будимо всіх отримувачів (у пакетній відправці вони
+        // ще не отримали сигнал) і паркуємо відправника, поки не звільниться місце
+        while (true) {
+            readable.notify_all();
+            if (wakeup)
+                wakeup->notify_all();
+            uint64_t ticket = writable.prepare_wait();
+            if (try_push(t)) {
+                writable.cancel_wait();
+                return;
+            }
+            writable.wait(ticket);
+            if (try_push(t))
+                return;
+        }
+    }
+
+    // будимо до n запаркованих отримувачів лише тоді, коли такі є (і стільки ж на спільному wakeup)
+    void wake_receivers(size_t n) {
+        if (n == 0)
+            return;
+        notify(readable, n);
+        if (wakeup)
+            notify(*wakeup, n);
+    }
+
+    static void notify(EventCount& signal, size_t n) {
+        if (n >= signal.num_waiters()) {
+            signal.notify_all();
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            signal.notify_one();
+        }
+    }
 };
 
 #endif // CHANNEL_HPP
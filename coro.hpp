@@ -0,0 +1,646 @@
+#ifndef CORO_HPP
+#define CORO_HPP
+
+// кооперативні задачі на корутинах C++20 поверх ThreadPool
+// корутина, що чекає на таймер або на інші задачі, не займає робітника: вона призупиняється,
+// а відновлення ставиться в пул як звичайне завдання, тож тисячі логічних задач виконуються
+// на кількох робітниках
+//
+//     coro::Task<int> fetch(int id) {
+//         co_await coro::sleep_for(std::chrono::milliseconds(200)); // таймер пулу, робітник вільний
+//         co_return id * 2;
+//     }
+//
+//     coro::Task<int> total() {
+//         std::vector<coro::Task<int>> parts;
+//         for (int i = 0; i < 100; ++i)
+//             parts.push_back(fetch(i));
+//         auto values = co_await coro::when_all(std::move(parts)); // підзадачі виконуються паралельно
+//         co_return std::accumulate(values.begin(), values.end(), 0);
+//     }
+//
+//     Future<int> result = pool.spawn(total());
+//
+// без підтримки корутин компілятором (до C++20) заголовок порожній
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "threadpool.hpp"
+
+namespace coro {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// лічильник when_all: кожна підзадача і сам споживач знімають по одиниці,
+// а той, хто зняв останню, продовжує споживача
+struct Latch;
+
+// власник ланцюжка задач: кадр Task::run (root), який знищується разом з усім ланцюжком,
+// або обгортка підзадачі when_all (latch, error — слот її результату)
+struct Scope {
+    std::coroutine_handle<> root;
+    Latch* latch = nullptr;
+    std::exception_ptr* error = nullptr;
+};
+
+// відновлення корутини відкинуто (див. Resume)
+inline void abandon(Scope* scope);
+
+// спільна частина обіцянок Task: пул, на якому виконується задача, корутина, що на неї чекає,
+// і власник ланцюжка, до якого задача належить
+struct PromiseBase {
+    ThreadPool* pool = nullptr;
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+    Scope* scope = nullptr;
+
+    // по завершенні керування переходить до корутини-споживача без проміжного завдання в пулі
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> self) noexcept {
+            if (auto next = self.promise().continuation)
+                return next;
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // задача лінива: тіло починає виконуватися, лише коли на неї чекають або її запущено через spawn()
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& u) {
+        value.emplace(std::forward<U>(u));
+    }
+
+    T take() {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void take() {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// пул корутини-споживача (nullptr, якщо її обіцянка не зберігає пул)
+template <typename P>
+ThreadPool* pool_of(std::coroutine_handle<P> handle) {
+    if constexpr (requires { handle.promise().pool; })
+        return handle.promise().pool;
+    else
+        return nullptr;
+}
+
+template <typename P>
+void bind_pool(std::coroutine_handle<P> handle, ThreadPool* pool) {
+    if constexpr (requires { handle.promise().pool; })
+        handle.promise().pool = pool;
+}
+
+template <typename P>
+Scope* scope_of(std::coroutine_handle<P> handle) {
+    if constexpr (requires { handle.promise().scope; })
+        return handle.promise().scope;
+    else
+        return nullptr;
+}
+
+// завдання відновлення корутини; якщо його знищено без запуску (пул відкинув завдання під час
+// зупинки чи через перевантаження, таймер скасовано), ланцюжок задач звільняється через abandon(),
+// тож кадри не залишаються висіти, а Future із spawn() отримує broken_promise
+// корутина без відомого власника (не Task) лишається призупиненою, як і раніше
+class Resume {
+public:
+    Resume(std::coroutine_handle<> handle, Scope* scope) noexcept
+        : handle(handle)
+        , scope(scope)
+    {
+    }
+
+    Resume(Resume&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr))
+        , scope(other.scope)
+    {
+    }
+
+    Resume(const Resume&) = delete;
+    Resume& operator=(const Resume&) = delete;
+
+    ~Resume() {
+        if (handle)
+            abandon(scope);
+    }
+
+    void operator()() {
+        std::exchange(handle, nullptr).resume();
+    }
+
+private:
+    std::coroutine_handle<> handle;
+    Scope* scope;
+};
+
+// відновлення корутини на робітнику пулу як звичайного завдання
+// якщо пул відкине завдання одразу, кадр корутини може бути знищений ще всередині виклику
+template <typename P>
+void resume_on(ThreadPool& pool, std::coroutine_handle<P> handle) {
+    pool.execute(Resume(handle, scope_of(handle)));
+}
+
+template <typename T>
+struct TaskAwaiter {
+    std::coroutine_handle<Promise<T>> handle;
+
+    bool await_ready() const noexcept {
+        return handle.done();
+    }
+
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        handle.promise().scope = scope_of(awaiting);
+        if (!handle.promise().pool)
+            handle.promise().pool = pool_of(awaiting);
+        return handle;
+    }
+
+    T await_resume() {
+        return handle.promise().take();
+    }
+};
+
+struct ScheduleAwaiter {
+    ThreadPool& pool;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <typename P>
+    void await_suspend(std::coroutine_handle<P> handle) {
+        bind_pool(handle, &pool);
+        resume_on(pool, handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct SleepAwaiter {
+    ThreadPool* pool;
+    std::chrono::steady_clock::time_point when;
+
+    bool await_ready() const {
+        return when <= std::chrono::steady_clock::now();
+    }
+
+    template <typename P>
+    void await_suspend(std::coroutine_handle<P> handle) {
+        ThreadPool* target = pool ? pool : pool_of(handle);
+        if (!target)
+            throw std::logic_error("coro::sleep_for: task is not bound to a ThreadPool");
+        bind_pool(handle, target);
+        target->execute_at(when, Resume(handle, scope_of(handle)));
+    }
+
+    void await_resume() const noexcept {}
+};
+
+// корутина без власника: запускається одразу й сама звільняє свій кадр після завершення
+// (або, якщо її відновлення відкинуто, кадр знищує abandon())
+struct Detached {
+    struct promise_type {
+        Scope self;
+        Scope* scope = &self;
+
+        Detached get_return_object() noexcept {
+            self.root = std::coroutine_handle<promise_type>::from_promise(*this);
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+    };
+};
+
+} // namespace detail
+
+// Task<T>: лінива корутина з результатом T; на неї можна чекати з іншої задачі (co_await)
+// або запустити на пулі через ThreadPool::spawn(); задача, на яку чекають, успадковує пул
+// споживача, тож sleep_for() без явного пулу працює в усьому ланцюжку
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+    using value_type = T;
+
+    Task() = default;
+
+    Task(Task&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    bool valid() const {
+        return static_cast<bool>(handle);
+    }
+
+    // очікування з іншої корутини: споживач призупиняється, задача одразу виконується в тому ж потоці
+    detail::TaskAwaiter<T> operator co_await() const noexcept {
+        return detail::TaskAwaiter<T>{handle};
+    }
+
+    // запуск на пулі з передачею результату в promise; викликається з ThreadPool::spawn()
+    void start(ThreadPool& pool, future_detail::Promise<T> promise) && {
+        run(pool, std::move(*this), std::move(promise));
+    }
+
+private:
+    friend promise_type;
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle(handle)
+    {
+    }
+
+    void reset() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+
+    static detail::Detached run(ThreadPool& pool, Task task, future_detail::Promise<T> promise);
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+// schedule_on(pool): продовжує корутину на робітнику pool (і прив'язує до нього задачу)
+inline detail::ScheduleAwaiter schedule_on(ThreadPool& pool) {
+    return detail::ScheduleAwaiter{pool};
+}
+
+// sleep_until / sleep_for: корутина призупиняється на таймері пулу і продовжується на його робітнику
+// без явного пулу використовується пул поточної задачі; поза пулом — std::logic_error
+inline detail::SleepAwaiter sleep_until(ThreadPool* pool, std::chrono::steady_clock::time_point when) {
+    return detail::SleepAwaiter{pool, when};
+}
+
+inline detail::SleepAwaiter sleep_until(std::chrono::steady_clock::time_point when) {
+    return sleep_until(nullptr, when);
+}
+
+inline detail::SleepAwaiter sleep_until(ThreadPool& pool, std::chrono::steady_clock::time_point when) {
+    return sleep_until(&pool, when);
+}
+
+template <typename Rep, typename Period>
+detail::SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> delay) {
+    return sleep_until(nullptr, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay));
+}
+
+template <typename Rep, typename Period>
+detail::SleepAwaiter sleep_for(ThreadPool& pool, std::chrono::duration<Rep, Period> delay) {
+    return sleep_until(&pool, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay));
+}
+
+namespace detail {
+
+// результат однієї підзадачі when_all
+template <typename T>
+struct Slot {
+    std::optional<T> value;
+    std::exception_ptr error;
+
+    T take() {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Slot<void> {
+    std::exception_ptr error;
+
+    void take() {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+struct Latch {
+    explicit Latch(size_t count)
+        : remaining(count + 1)
+    {
+    }
+
+    bool arrive() {
+        return remaining.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    std::atomic<size_t> remaining;
+    std::coroutine_handle<> waiter;
+    Scope* scope = nullptr; // власник споживача
+};
+
+// ланцюжок, чиє відновлення відкинуто, звільняється з боку власника: кадр Task::run знищується
+// (разом з усіма задачами, на які він чекає, і обіцянкою Future — звідси broken_promise);
+// підзадача when_all отримує broken_promise як результат і знімає свою одиницю, а якщо вона
+// остання, відкинутим вважається і сам споживач (її кадр звільнить when_all)
+inline void abandon(Scope* scope) {
+    if (!scope)
+        return;
+    if (!scope->latch) {
+        scope->root.destroy();
+        return;
+    }
+    if (!*scope->error)
+        *scope->error = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+    Latch* latch = scope->latch;
+    if (latch->arrive())
+        abandon(latch->scope);
+}
+
+// обгортка підзадачі: кадр звільняє when_all після завершення всіх підзадач
+struct Item {
+    struct promise_type {
+        Scope self; // latch заповнює RunAll
+        Scope* scope = &self;
+        ThreadPool* pool = nullptr; // передається задачі, яку чекає обгортка
+
+        template <typename Task, typename S>
+        promise_type(Task&, S& slot) noexcept {
+            self.error = &slot.error;
+        }
+
+        Item get_return_object() noexcept {
+            return Item(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        auto final_suspend() const noexcept {
+            struct Awaiter {
+                bool await_ready() const noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                    Latch* latch = self.promise().self.latch;
+                    if (latch->arrive())
+                        return latch->waiter;
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+    };
+
+    explicit Item(std::coroutine_handle<promise_type> handle)
+        : handle(handle)
+    {
+    }
+
+    Item(Item&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr))
+    {
+    }
+
+    Item(const Item&) = delete;
+    Item& operator=(const Item&) = delete;
+
+    ~Item() {
+        if (handle)
+            handle.destroy();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T>
+Item run_item(Task<T> task, Slot<T>& slot) {
+    try {
+        if constexpr (std::is_void<T>::value)
+            co_await task;
+        else
+            slot.value.emplace(co_await task);
+    } catch (...) {
+        slot.error = std::current_exception();
+    }
+}
+
+// пул поточної задачі без призупинення
+struct CurrentPool {
+    ThreadPool* pool = nullptr;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <typename P>
+    bool await_suspend(std::coroutine_handle<P> handle) noexcept {
+        pool = pool_of(handle);
+        return false;
+    }
+
+    ThreadPool* await_resume() const noexcept {
+        return pool;
+    }
+};
+
+// запуск підзадач: на пулі кожна стає окремим завданням, без пулу — виконуються по черзі тут же
+struct RunAll {
+    std::vector<Item>& items;
+    Latch& latch;
+    ThreadPool* pool;
+
+    bool await_ready() const noexcept {
+        return items.empty();
+    }
+
+    template <typename P>
+    bool await_suspend(std::coroutine_handle<P> handle) {
+        latch.waiter = handle;
+        latch.scope = scope_of(handle);
+        for (auto &item : items) {
+            item.handle.promise().self.latch = &latch;
+            item.handle.promise().pool = pool;
+            if (pool)
+                resume_on(*pool, item.handle);
+            else
+                item.handle.resume();
+        }
+        return !latch.arrive();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+// when_all: виконує задачі паралельно на пулі поточної задачі і повертає їхні результати в
+// початковому порядку; якщо хоч одна задача кинула виняток, перший з них перекидається
+// після завершення всіх
+template <typename T>
+Task<std::conditional_t<std::is_void<T>::value, void, std::vector<T>>> when_all(std::vector<Task<T>> tasks) {
+    ThreadPool* pool = co_await detail::CurrentPool{};
+    std::vector<detail::Slot<T>> slots(tasks.size());
+    std::vector<detail::Item> items;
+    items.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i)
+        items.push_back(detail::run_item(std::move(tasks[i]), slots[i]));
+    detail::Latch latch(items.size());
+    co_await detail::RunAll{items, latch, pool};
+
+    if constexpr (std::is_void<T>::value) {
+        for (auto &slot : slots)
+            slot.take();
+    } else {
+        std::vector<T> values;
+        values.reserve(slots.size());
+        for (auto &slot : slots)
+            values.push_back(slot.take());
+        co_return values;
+    }
+}
+
+// when_all для різнотипних задач: результат — кортеж значень (задачі мають повертати значення)
+template <typename... Ts>
+Task<std::tuple<Ts...>> when_all(Task<Ts>... tasks) {
+    static_assert((!std::is_void<Ts>::value && ...), "coro::when_all(Task...) requires non-void tasks");
+    ThreadPool* pool = co_await detail::CurrentPool{};
+    std::tuple<detail::Slot<Ts>...> slots;
+    std::vector<detail::Item> items;
+    items.reserve(sizeof...(Ts));
+    std::apply([&](auto&... slot) {
+        (items.push_back(detail::run_item(std::move(tasks), slot)), ...);
+    }, slots);
+    detail::Latch latch(items.size());
+    co_await detail::RunAll{items, latch, pool};
+    co_return std::apply([](auto&... slot) { return std::tuple<Ts...>(slot.take()...); }, slots);
+}
+
+// тіло spawn(): перехід на робітника пулу, виконання задачі й передача результату у Future
+template <typename T>
+detail::Detached Task<T>::run(ThreadPool& pool, Task task, future_detail::Promise<T> promise) {
+    co_await schedule_on(pool);
+    task.handle.promise().pool = &pool;
+    std::exception_ptr error;
+    std::optional<std::conditional_t<std::is_void<T>::value, char, T>> value;
+    try {
+        if constexpr (std::is_void<T>::value)
+            co_await task;
+        else
+            value.emplace(co_await task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (error) {
+        promise.fail(error);
+    } else if constexpr (std::is_void<T>::value) {
+        promise.run([]() {});
+    } else {
+        promise.run([&]() -> T { return std::move(*value); });
+    }
+}
+
+} // namespace coro
+
+#endif // __cpp_impl_coroutine
+
+#endif // CORO_HPP
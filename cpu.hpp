@@ -0,0 +1,35 @@
+#ifndef CPU_HPP
+#define CPU_HPP
+
+#include <cstddef>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// розмір кеш-лінії, за яким вирівнюються атомарні лічильники, щоб уникнути false sharing
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// підказка процесору, що потік крутиться в циклі очікування
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// крок активного очікування: перші ітерації — cpu_relax(), далі потік поступається процесором
+constexpr unsigned SPIN_YIELD_AFTER = 32;
+
+inline void spin_backoff(unsigned spins) {
+    if (spins < SPIN_YIELD_AFTER)
+        cpu_relax();
+    else
+        std::this_thread::yield();
+}
+
+#endif // CPU_HPP
@@ -0,0 +1,87 @@
+#ifndef EVENT_COUNT_HPP
+#define EVENT_COUNT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include "cpu.hpp"
+
+// eventcount: потік спершу бере "квиток" через prepare_wait(), ще раз перевіряє
+// джерела роботи і лише тоді засинає в wait(); будь-який notify після prepare_wait()
+// змінює epoch, тому сигнал не губиться, навіть якщо він прийшов до самого wait()
+class EventCount {
+public:
+    // реєструє потік як сплячий і повертає поточну епоху
+    uint64_t prepare_wait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    // скасування очікування, якщо після prepare_wait() робота таки знайшлася
+    void cancel_wait() {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // сон, поки епоха не зміниться
+    void wait(uint64_t ticket) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (epoch.load(std::memory_order_acquire) == ticket) {
+            cond.wait(lock);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // сон, поки епоха не зміниться або не настане deadline; false — вийшов час
+    template <typename Clock, typename Duration>
+    bool wait_until(uint64_t ticket, const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::unique_lock<std::mutex> lock(mtx);
+        bool changed = true;
+        while (epoch.load(std::memory_order_acquire) == ticket) {
+            if (cond.wait_until(lock, deadline) == std::cv_status::timeout) {
+                changed = epoch.load(std::memory_order_acquire) != ticket;
+                break;
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return changed;
+    }
+
+    // будить один сплячий потік; якщо сплячих немає — нічого не робить
+    void notify_one() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            epoch.fetch_add(1, std::memory_order_release);
+        }
+        cond.notify_one();
+    }
+
+    void notify_all() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            epoch.fetch_add(1, std::memory_order_release);
+        }
+        cond.notify_all();
+    }
+
+    // кількість потоків, що зараз сплять або готуються заснути
+    size_t num_waiters() const {
+        return waiters.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> epoch{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> waiters{0};
+    std::mutex mtx;
+    std::condition_variable cond;
+};
+
+#endif // EVENT_COUNT_HPP
@@ -0,0 +1,369 @@
+#ifndef FUTURE_HPP
+#define FUTURE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "cpu.hpp"
+#include "job.hpp"
+
+class ThreadPool;
+
+// передає продовження (then) на виконання: визначено в threadpool.hpp, бо потребує повного типу ThreadPool
+// якщо виклик відбувається в робітнику цього пулу, продовження кладеться в його локальний дек
+inline void post_continuation(ThreadPool* pool, Job job);
+
+namespace future_detail {
+
+// тип-заглушка для зберігання результату Future<void>
+struct Unit {};
+
+// спільна таблиця паркування: потоки, що чекають на Future, сплять на одному з кошиків,
+// обраному за адресою стану; завдяки цьому стан не містить власних м'ютекса й умовної змінної
+struct ParkingBucket {
+    std::mutex mtx;
+    std::condition_variable cond;
+};
+
+inline ParkingBucket& parking_bucket(const void* address) {
+    static ParkingBucket buckets[64];
+    auto key = reinterpret_cast<uintptr_t>(address);
+    return buckets[(key >> 6) % 64];
+}
+
+// спільний стан Future: результат, виняток і одне продовження
+// синхронізація — через одне атомарне слово flags, тож виконавець завершує завдання без блокувань
+// пам'ять береться з JobSlab пулу, посилання рахуються вручну (Promise + Future)
+// результат-посилання (T& чи T&&) зберігається як вказівник і повертається тим самим посиланням
+template <typename T>
+class State {
+public:
+    using Stored = std::conditional_t<std::is_void<T>::value, Unit,
+                   std::conditional_t<std::is_reference<T>::value, std::remove_reference_t<T>*, T>>;
+    using Result = std::conditional_t<std::is_void<T>::value, Unit, T>;
+
+    static State* create(ThreadPool* pool, JobSlab* slab) {
+        void* memory = slab ? slab->allocate(sizeof(State)) : ::operator new(sizeof(State));
+        return new (memory) State(pool, slab);
+    }
+
+    void add_ref() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        JobSlab* owner = slab;
+        this->~State();
+        if (owner)
+            owner->deallocate(this, sizeof(State));
+        else
+            ::operator delete(this);
+    }
+
+    template <typename... U>
+    void set_value(U&&... u) {
+        if constexpr (std::is_reference<T>::value)
+            new (value) Stored(std::addressof(u)...);
+        else
+            new (value) Stored(std::forward<U>(u)...);
+        complete(0);
+    }
+
+    void set_exception(std::exception_ptr e) {
+        error = std::move(e);
+        complete(FAILED);
+    }
+
+    bool is_ready() const {
+        return flags.load(std::memory_order_acquire) & READY;
+    }
+
+    // блокування до готовності результату: короткий спін, потім сон на кошику таблиці паркування
+    void wait() {
+        for (unsigned spins = 0; spins < 64; ++spins) {
+            if (is_ready())
+                return;
+            cpu_relax();
+        }
+        ParkingBucket& bucket = parking_bucket(this);
+        std::unique_lock<std::mutex> lock(bucket.mtx);
+        uint32_t prev = flags.fetch_or(WAITERS, std::memory_order_acq_rel);
+        if (prev & READY)
+            return;
+        bucket.cond.wait(lock, [this]() { return is_ready(); });
+    }
+
+    // забирає результат (або кидає збережений виняток); викликається один раз після wait()
+    Result take() {
+        if (flags.load(std::memory_order_acquire) & FAILED)
+            std::rethrow_exception(error);
+        if constexpr (std::is_reference<T>::value)
+            return static_cast<T>(**stored());
+        else
+            return std::move(*stored());
+    }
+
+    bool failed() const {
+        return flags.load(std::memory_order_acquire) & FAILED;
+    }
+
+    std::exception_ptr get_exception() const {
+        return error;
+    }
+
+    // встановлює єдине продовження; якщо результат уже готовий, відправляє його одразу
+    void set_continuation(Job job) {
+        continuation = std::move(job);
+        uint32_t prev = flags.fetch_or(CONTINUATION, std::memory_order_acq_rel);
+        if (prev & READY)
+            post_continuation(pool, std::move(continuation));
+    }
+
+    ThreadPool* get_pool() const {
+        return pool;
+    }
+
+    JobSlab* get_slab() const {
+        return slab;
+    }
+
+private:
+    static constexpr uint32_t READY = 1;
+    static constexpr uint32_t FAILED = 2;
+    static constexpr uint32_t CONTINUATION = 4;
+    static constexpr uint32_t WAITERS = 8;
+
+    std::atomic<uint32_t> flags{0};
+    std::atomic<uint32_t> refs{1};
+    ThreadPool* pool;
+    JobSlab* slab;
+    std::exception_ptr error;
+    Job continuation;
+    alignas(Stored) unsigned char value[sizeof(Stored)];
+
+    State(ThreadPool* pool, JobSlab* slab)
+        : pool(pool)
+        , slab(slab)
+    {
+    }
+
+    ~State() {
+        uint32_t f = flags.load(std::memory_order_acquire);
+        if ((f & READY) && !(f & FAILED))
+            stored()->~Stored();
+    }
+
+    Stored* stored() {
+        return std::launder(reinterpret_cast<Stored*>(value));
+    }
+
+    // публікація результату; продовження й сплячі потоки обробляє той, хто завершив завдання
+    void complete(uint32_t extra) {
+        uint32_t prev = flags.fetch_or(READY | extra, std::memory_order_acq_rel);
+        if (prev & CONTINUATION)
+            post_continuation(pool, std::move(continuation));
+        if (prev & WAITERS) {
+            ParkingBucket& bucket = parking_bucket(this);
+            { std::lock_guard<std::mutex> lock(bucket.mtx); }
+            bucket.cond.notify_all();
+        }
+    }
+};
+
+// сторона виконавця: якщо завдання знищене без результату (наприклад, пул зупинився),
+// Future отримує std::future_error(broken_promise)
+template <typename T>
+class Promise {
+public:
+    explicit Promise(State<T>* state)
+        : state(state)
+    {
+    }
+
+    Promise(Promise&& other) noexcept
+        : state(other.state)
+    {
+        other.state = nullptr;
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+    Promise& operator=(Promise&&) = delete;
+
+    ~Promise() {
+        if (!state)
+            return;
+        state->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        state->release();
+    }
+
+    // виконує f і зберігає його результат або виняток
+    template <typename F>
+    void run(F&& f) {
+        State<T>* s = state;
+        state = nullptr;
+        try {
+            if constexpr (std::is_void<T>::value) {
+                std::forward<F>(f)();
+                s->set_value();
+            } else {
+                s->set_value(std::forward<F>(f)());
+            }
+        } catch (...) {
+            job_failed_flag() = true;
+            s->set_exception(std::current_exception());
+        }
+        s->release();
+    }
+
+    void fail(std::exception_ptr e) {
+        State<T>* s = state;
+        state = nullptr;
+        s->set_exception(std::move(e));
+        s->release();
+    }
+
+private:
+    State<T>* state;
+};
+
+} // namespace future_detail
+
+// Future: легкий дескриптор результату завдання, отриманого з ThreadPool::submit()
+// get() блокує до готовності та повертає значення або перекидає виняток завдання
+// then(f) ставить f у чергу робітника, що завершив завдання, і повертає Future результату f
+// для завдань, що повертають посилання (Future<T&>), get() повертає те саме посилання:
+// об'єкт, на який воно вказує, має жити до виклику get() чи продовження
+template <typename T>
+class Future {
+    template <typename F, bool = std::is_void<T>::value>
+    struct continuation_result {
+        using type = std::invoke_result_t<std::decay_t<F>&>;
+    };
+
+    template <typename F>
+    struct continuation_result<F, false> {
+        using type = std::invoke_result_t<std::decay_t<F>&, T>;
+    };
+
+    // RAII-власник одного посилання на стан
+    struct Holder {
+        future_detail::State<T>* state;
+
+        explicit Holder(future_detail::State<T>* state)
+            : state(state)
+        {
+        }
+
+        Holder(Holder&& other) noexcept
+            : state(std::exchange(other.state, nullptr))
+        {
+        }
+
+        ~Holder() {
+            if (state)
+                state->release();
+        }
+    };
+
+public:
+    Future() = default;
+
+    explicit Future(future_detail::State<T>* state)
+        : state(state)
+    {
+    }
+
+    Future(Future&& other) noexcept
+        : state(other.state)
+    {
+        other.state = nullptr;
+    }
+
+    Future& operator=(Future&& other) noexcept {
+        if (this != &other) {
+            reset();
+            state = other.state;
+            other.state = nullptr;
+        }
+        return *this;
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    ~Future() {
+        reset();
+    }
+
+    bool valid() const {
+        return state != nullptr;
+    }
+
+    bool is_ready() const {
+        return state && state->is_ready();
+    }
+
+    void wait() const {
+        state->wait();
+    }
+
+    // результат завдання; Future після цього стає недійсним
+    T get() {
+        state->wait();
+        Holder holder(std::exchange(state, nullptr));
+        if constexpr (std::is_void<T>::value)
+            holder.state->take();
+        else
+            return holder.state->take();
+    }
+
+    // продовження: f отримує результат цього Future (або нічого для Future<void>)
+    // якщо завдання завершилося винятком, f не викликається, а виняток переходить у новий Future
+    template <typename F>
+    auto then(F&& f) -> Future<typename continuation_result<F>::type> {
+        using U = typename continuation_result<F>::type;
+        future_detail::State<T>* parent = std::exchange(state, nullptr);
+        auto* child = future_detail::State<U>::create(parent->get_pool(), parent->get_slab());
+        child->add_ref();
+
+        Job job([parent = Holder(parent), promise = future_detail::Promise<U>(child), fn = std::forward<F>(f)]() mutable {
+            if (parent.state->failed()) {
+                promise.fail(parent.state->get_exception());
+                return;
+            }
+            promise.run([&]() -> U {
+                if constexpr (std::is_void<T>::value) {
+                    parent.state->take();
+                    return fn();
+                } else {
+                    return fn(parent.state->take());
+                }
+            });
+        }, parent->get_slab());
+
+        parent->set_continuation(std::move(job));
+        return Future<U>(child);
+    }
+
+private:
+    future_detail::State<T>* state = nullptr;
+
+    void reset() {
+        if (state) {
+            state->release();
+            state = nullptr;
+        }
+    }
+};
+
+#endif // FUTURE_HPP
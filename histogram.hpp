@@ -0,0 +1,144 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "cpu.hpp"
+
+// зведення гістограми: кількість, середнє та перцентилі в наносекундах
+struct LatencySnapshot {
+    uint64_t count = 0;
+    double mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// гістограма затримок у стилі HDR з логарифмічно-лінійними кошиками:
+// значення до 2^SUB_BITS наносекунд зберігаються точно, далі кожен інтервал [2^e, 2^(e+1))
+// ділиться на 2^SUB_BITS рівних кошиків (відносна похибка до ~3%)
+// пам'ять стала (BUCKETS лічильників) незалежно від кількості записів
+// запис робить лише один потік (власник), тому достатньо relaxed load/store без RMW;
+// читачі будь-якого потоку зливають кошики в merge_into() без блокувань
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+    static constexpr size_t BUCKETS = SUB_COUNT + (64 - SUB_BITS) * SUB_COUNT;
+
+    LatencyHistogram() {
+        for (auto &bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // запис значення в наносекундах; викликається лише потоком-власником
+    void record(uint64_t value) {
+        bump(buckets[index_of(value)], 1);
+        bump(count, 1);
+        bump(sum, value);
+        if (value > max.load(std::memory_order_relaxed))
+            max.store(value, std::memory_order_relaxed);
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> d) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    // кількість записів і їх сума (для гістограми часу — сумарний час)
+    uint64_t samples() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+        return sum.load(std::memory_order_relaxed);
+    }
+
+    // додає кошики цієї гістограми до counts (розміру BUCKETS) та сумарні показники
+    void merge_into(std::vector<uint64_t>& counts, uint64_t& total_count, uint64_t& total_sum, uint64_t& total_max) const {
+        for (size_t i = 0; i < BUCKETS; ++i)
+            counts[i] += buckets[i].load(std::memory_order_relaxed);
+        total_count += count.load(std::memory_order_relaxed);
+        total_sum += sum.load(std::memory_order_relaxed);
+        total_max = std::max(total_max, max.load(std::memory_order_relaxed));
+    }
+
+    LatencySnapshot snapshot() const {
+        const LatencyHistogram* self = this;
+        return merge(&self, &self + 1);
+    }
+
+    // злиття кількох гістограм (наприклад, усіх робітників) у одне зведення
+    template <typename It>
+    static LatencySnapshot merge(It first, It last) {
+        std::vector<uint64_t> counts(BUCKETS, 0);
+        uint64_t total_count = 0, total_sum = 0, total_max = 0;
+        for (; first != last; ++first)
+            (*first)->merge_into(counts, total_count, total_sum, total_max);
+
+        LatencySnapshot snap;
+        // лічильник count оновлюється окремо від кошиків, тож для перцентилів беремо суму кошиків
+        uint64_t in_buckets = 0;
+        for (auto c : counts)
+            in_buckets += c;
+        snap.count = total_count;
+        snap.max = total_max;
+        if (total_count > 0)
+            snap.mean = static_cast<double>(total_sum) / total_count;
+        snap.p50 = std::min(percentile(counts, in_buckets, 0.5), total_max);
+        snap.p99 = std::min(percentile(counts, in_buckets, 0.99), total_max);
+        snap.p999 = std::min(percentile(counts, in_buckets, 0.999), total_max);
+        return snap;
+    }
+
+    static size_t index_of(uint64_t value) {
+        if (value < SUB_COUNT)
+            return static_cast<size_t>(value);
+        unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        uint64_t sub = (value >> (exponent - SUB_BITS)) - SUB_COUNT;
+        return static_cast<size_t>(SUB_COUNT + (exponent - SUB_BITS) * SUB_COUNT + sub);
+    }
+
+    // верхня межа значень кошика (включно)
+    static uint64_t upper_bound_of(size_t index) {
+        if (index < SUB_COUNT)
+            return index;
+        uint64_t exponent = (index - SUB_COUNT) / SUB_COUNT + SUB_BITS;
+        uint64_t sub = (index - SUB_COUNT) % SUB_COUNT;
+        uint64_t width = 1ull << (exponent - SUB_BITS);
+        return ((SUB_COUNT + sub) << (exponent - SUB_BITS)) + (width - 1);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+    std::atomic<uint64_t> buckets[BUCKETS];
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    static uint64_t percentile(const std::vector<uint64_t>& counts, uint64_t total, double q) {
+        if (total == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank)
+                return upper_bound_of(i);
+        }
+        return upper_bound_of(counts.size() - 1);
+    }
+};
+
+#endif // HISTOGRAM_HPP
@@ -0,0 +1,401 @@
+#ifndef JOB_HPP
+#define JOB_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cpu.hpp"
+
+// розмір об'єкта Job у байтах (вбудований буфер + вказівник на таблицю операцій + час надходження)
+// за замовчуванням дорівнює кеш-лінії; можна змінити через -DJOB_INLINE_SIZE=...
+#ifndef JOB_INLINE_SIZE
+#define JOB_INLINE_SIZE 64
+#endif
+
+// slab-алокатор для захоплень, що не вміщуються у вбудований буфер Job, станів Future
+// і вузлів локальних деків робітників
+// блоки розбиті на класи розмірів 64/128/256/512/1024 байти; кожен потік тримає власний магазин
+// вільних блоків кожного класу, тож виділення і звільнення зазвичай не торкаються спільного стану,
+// а м'ютекс класу береться лише для обміну пачкою блоків між магазином і спільним списком
+// (блок, звільнений в іншому потоці, ніж виділений, потрапляє в магазин того потоку)
+// спільні списки й чанки живуть, поки на них посилається slab або магазин якогось потоку
+// більші захоплення виділяються звичайним operator new
+class JobSlab {
+public:
+    JobSlab()
+        : central(std::make_shared<Central>())
+    {
+    }
+
+    JobSlab(const JobSlab&) = delete;
+    JobSlab& operator=(const JobSlab&) = delete;
+
+    void* allocate(size_t size) {
+        size_t cls = size_class(size);
+        if (cls == NUM_CLASSES)
+            return ::operator new(size);
+
+        Magazine& mag = magazine(cls);
+        if (mag.count == 0)
+            central->take(cls, mag, MAGAZINE_SIZE / 2);
+        return mag.blocks[--mag.count];
+    }
+
+    void deallocate(void* ptr, size_t size) {
+        size_t cls = size_class(size);
+        if (cls == NUM_CLASSES) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        Magazine& mag = magazine(cls);
+        if (mag.count == MAGAZINE_SIZE)
+            central->give(cls, mag, MAGAZINE_SIZE / 2);
+        mag.blocks[mag.count++] = ptr;
+    }
+
+private:
+    static constexpr size_t NUM_CLASSES = 5;
+    static constexpr size_t MIN_BLOCK = 64;
+    static constexpr size_t BLOCKS_PER_CHUNK = 64;
+    static constexpr size_t MAGAZINE_SIZE = 32;
+    // скільки різних slab один потік обслуговує з магазинів одночасно (зазвичай один пул)
+    static constexpr size_t CACHED_SLABS = 4;
+
+    struct Node {
+        Node* next;
+    };
+
+    struct Magazine {
+        void* blocks[MAGAZINE_SIZE];
+        size_t count = 0;
+    };
+
+    // спільні списки вільних блоків і чанки, з яких вони нарізані
+    struct Central {
+        struct alignas(CACHE_LINE_SIZE) Pool {
+            std::mutex mtx;
+            Node* free = nullptr;
+            std::vector<std::unique_ptr<unsigned char[]>> chunks;
+        };
+
+        Pool pools[NUM_CLASSES];
+
+        void take(size_t cls, Magazine& mag, size_t n) {
+            Pool& pool = pools[cls];
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            for (; n > 0; --n) {
+                if (!pool.free)
+                    refill(pool, block_size(cls));
+                Node* node = pool.free;
+                pool.free = node->next;
+                mag.blocks[mag.count++] = node;
+            }
+        }
+
+        void give(size_t cls, Magazine& mag, size_t n) {
+            Pool& pool = pools[cls];
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            for (; n > 0 && mag.count > 0; --n) {
+                Node* node = static_cast<Node*>(mag.blocks[--mag.count]);
+                node->next = pool.free;
+                pool.free = node;
+            }
+        }
+
+        // виділення цілого чанку блоків одного класу за раз
+        static void refill(Pool& pool, size_t block) {
+            pool.chunks.emplace_back(new unsigned char[block * BLOCKS_PER_CHUNK]);
+            unsigned char* chunk = pool.chunks.back().get();
+            for (size_t i = 0; i < BLOCKS_PER_CHUNK; ++i) {
+                Node* node = reinterpret_cast<Node*>(chunk + i * block);
+                node->next = pool.free;
+                pool.free = node;
+            }
+        }
+    };
+
+    // магазини потоку для кількох slab; при завершенні потоку або витісненні блоки
+    // повертаються у спільні списки свого slab
+    struct ThreadCache {
+        struct Slot {
+            std::shared_ptr<Central> owner;
+            Magazine mags[NUM_CLASSES];
+        };
+
+        Slot slots[CACHED_SLABS];
+        size_t victim = 0;
+
+        ThreadCache() = default;
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+        ~ThreadCache() {
+            for (auto &slot : slots)
+                flush(slot);
+        }
+
+        static void flush(Slot& slot) {
+            if (!slot.owner)
+                return;
+            for (size_t cls = 0; cls < NUM_CLASSES; ++cls)
+                slot.owner->give(cls, slot.mags[cls], MAGAZINE_SIZE);
+            slot.owner.reset();
+        }
+
+        Slot& find(const std::shared_ptr<Central>& central) {
+            for (auto &slot : slots)
+                if (slot.owner == central)
+                    return slot;
+            for (auto &slot : slots) {
+                if (!slot.owner) {
+                    slot.owner = central;
+                    return slot;
+                }
+            }
+            Slot& slot = slots[victim];
+            victim = (victim + 1) % CACHED_SLABS;
+            flush(slot);
+            slot.owner = central;
+            return slot;
+        }
+    };
+
+    std::shared_ptr<Central> central;
+
+    Magazine& magazine(size_t cls) {
+        thread_local ThreadCache cache;
+        return cache.find(central).mags[cls];
+    }
+
+    static size_t block_size(size_t cls) {
+        return MIN_BLOCK << cls;
+    }
+
+    static size_t size_class(size_t size) {
+        size_t cls = 0;
+        while (cls < NUM_CLASSES && block_size(cls) < size)
+            ++cls;
+        return cls;
+    }
+};
+
+// позначка потоку: завдання, що зараз виконується, завершилося винятком, який воно перехопило
+// саме (наприклад, Promise::run() передає виняток у Future); робітник зараховує таке завдання в failed
+inline bool& job_failed_flag() noexcept {
+    thread_local bool failed = false;
+    return failed;
+}
+
+// межі одного завдання для job_failed_flag(): завдання, виконане всередині іншого на тому ж потоці
+// (CallerRuns, завдання Strand), починає з чистої позначки, а позначка зовнішнього відновлюється
+// після нього, тож перехоплений вкладений виняток не робить зовнішнє завдання невдалим
+class JobFailedScope {
+public:
+    JobFailedScope() noexcept
+        : outer(job_failed_flag())
+    {
+        job_failed_flag() = false;
+    }
+
+    JobFailedScope(const JobFailedScope&) = delete;
+    JobFailedScope& operator=(const JobFailedScope&) = delete;
+
+    ~JobFailedScope() {
+        job_failed_flag() = outer;
+    }
+
+private:
+    bool outer;
+};
+
+// Job: move-only функція без параметрів, що повертає void
+// невеликі захоплення (до INLINE_CAPACITY байт) зберігаються всередині об'єкта
+// без виділення пам'яті; більші — у блоці з JobSlab пулу (або в купі, якщо slab не передано)
+// порожній Job (Job()) використовується як сигнал зупинки робітника
+// Job також несе час надходження в пул, за яким робітник рахує час у черзі та наскрізну затримку
+class Job {
+public:
+    Job() noexcept = default;
+
+    Job(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value &&
+                                          !std::is_same<std::decay_t<F>, std::nullptr_t>::value &&
+                                          std::is_invocable<std::decay_t<F>&>::value>>
+    Job(F&& f, JobSlab* slab = nullptr) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>()) {
+            new (storage) Fn(std::forward<F>(f));
+            ops = &inline_ops<Fn>;
+        } else {
+            Heap* heap = new (storage) Heap{allocate<Fn>(slab), slab};
+            // виняток з конструктора захоплення не повинен залишити блок виділеним
+            try {
+                new (heap->ptr) Fn(std::forward<F>(f));
+            } catch (...) {
+                deallocate<Fn>(*heap);
+                throw;
+            }
+            ops = &heap_ops<Fn>;
+        }
+    }
+
+    Job(Job&& other) noexcept
+        : submitted(other.submitted)
+    {
+        take(other);
+    }
+
+    Job& operator=(Job&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+            submitted = other.submitted;
+        }
+        return *this;
+    }
+
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+
+    ~Job() {
+        reset();
+    }
+
+    // виклик порожнього Job — помилка викликача, як і для порожньої std::function
+    void operator()() {
+        if (!ops)
+            throw std::bad_function_call();
+        ops->invoke(storage);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    // чи зберігається захоплення у вбудованому буфері (без виділення пам'яті)
+    bool is_inline() const noexcept {
+        return ops && ops->is_inline;
+    }
+
+    // приблизний обсяг пам'яті завдання: сам Job плюс захоплення поза вбудованим буфером
+    // (використовується для меж буфера планувальника в байтах)
+    size_t footprint() const noexcept {
+        return sizeof(Job) + (ops ? ops->heap_size : 0);
+    }
+
+    // позначка часу надходження в пул (ставиться планувальником або робітником при локальному push)
+    void set_submit_time(std::chrono::steady_clock::time_point tp) noexcept {
+        submitted = tp.time_since_epoch().count();
+    }
+
+    bool has_submit_time() const noexcept {
+        return submitted != 0;
+    }
+
+    std::chrono::steady_clock::time_point submit_time() const noexcept {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(submitted));
+    }
+
+    static constexpr size_t INLINE_CAPACITY = JOB_INLINE_SIZE - sizeof(void*) - sizeof(std::chrono::steady_clock::rep);
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void*) noexcept;
+        bool is_inline;
+        size_t heap_size; // розмір захоплення поза буфером (0 — вбудоване)
+    };
+
+    // захоплення поза буфером: вказівник на блок і slab, якому його повернути
+    struct Heap {
+        void* ptr;
+        JobSlab* slab;
+    };
+
+    // вбудований буфер має вміщати хоча б Heap, інакше великі захоплення писали б поза storage
+    static_assert(JOB_INLINE_SIZE >= sizeof(void*) + sizeof(std::chrono::steady_clock::rep) + sizeof(Heap),
+                  "JOB_INLINE_SIZE is too small: the inline buffer must hold a heap pointer and a slab pointer");
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_CAPACITY];
+    const Ops* ops = nullptr;
+    std::chrono::steady_clock::rep submitted = 0;
+
+    template <typename Fn>
+    static constexpr bool fits_inline() {
+        return sizeof(Fn) <= INLINE_CAPACITY
+            && alignof(Fn) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<Fn>::value;
+    }
+
+    template <typename Fn>
+    static void* allocate(JobSlab* slab) {
+        if (alignof(Fn) > alignof(std::max_align_t))
+            return ::operator new(sizeof(Fn), std::align_val_t(alignof(Fn)));
+        return slab ? slab->allocate(sizeof(Fn)) : ::operator new(sizeof(Fn));
+    }
+
+    template <typename Fn>
+    static void deallocate(const Heap& heap) noexcept {
+        if (alignof(Fn) > alignof(std::max_align_t))
+            ::operator delete(heap.ptr, std::align_val_t(alignof(Fn)));
+        else if (heap.slab)
+            heap.slab->deallocate(heap.ptr, sizeof(Fn));
+        else
+            ::operator delete(heap.ptr);
+    }
+
+    template <typename Fn>
+    static constexpr Ops inline_ops = {
+        [](void* s) { (*static_cast<Fn*>(s))(); },
+        [](void* dst, void* src) noexcept {
+            Fn* f = static_cast<Fn*>(src);
+            new (dst) Fn(std::move(*f));
+            f->~Fn();
+        },
+        [](void* s) noexcept { static_cast<Fn*>(s)->~Fn(); },
+        true,
+        0
+    };
+
+    template <typename Fn>
+    static constexpr Ops heap_ops = {
+        [](void* s) { (*static_cast<Fn*>(static_cast<Heap*>(s)->ptr))(); },
+        [](void* dst, void* src) noexcept {
+            new (dst) Heap(*static_cast<Heap*>(src));
+        },
+        [](void* s) noexcept {
+            Heap* heap = static_cast<Heap*>(s);
+            static_cast<Fn*>(heap->ptr)->~Fn();
+            deallocate<Fn>(*heap);
+        },
+        false,
+        sizeof(Fn)
+    };
+
+    void take(Job& other) noexcept {
+        if (other.ops) {
+            other.ops->move(storage, other.storage);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+};
+
+#endif // JOB_HPP
@@ -0,0 +1,173 @@
+#ifndef JOB_QUEUE_HPP
+#define JOB_QUEUE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "job.hpp"
+
+// класи пріоритету завдань; менше значення — терміновіший клас
+enum class Priority {
+    High = 0,
+    Normal = 1,
+    Low = 2
+};
+
+constexpr size_t NUM_PRIORITIES = 3;
+
+inline const char* priority_name(Priority priority) {
+    switch (priority) {
+        case Priority::High: return "high";
+        case Priority::Normal: return "normal";
+        case Priority::Low: return "low";
+    }
+    return "unknown";
+}
+
+// завдання в буфері планувальника разом з часом надходження та дедлайном
+struct QueuedJob {
+    Job job;
+    std::chrono::steady_clock::time_point enqueued;
+    std::chrono::steady_clock::time_point deadline;
+    Priority priority;
+    uint64_t seq; // порядковий номер надходження для стабільного порядку при однакових дедлайнах
+    bool pinned; // не витісняється через evict()
+};
+
+// багаторівнева черга з вибором за найближчим дедлайном (EDF)
+// завдання без явного дедлайну отримують дедлайн "час надходження + бюджет класу" і лежать у FIFO
+// свого класу (усередині класу такі дедлайни зростають, тож голова FIFO — найтерміновіша);
+// завдання з явним дедлайном лежать в окремій купі
+// старіння: завдання низького класу з часом має дедлайн раніший, ніж щойно надіслане
+// завдання високого класу, тож воно не голодує навіть під постійним потоком High
+class JobQueue {
+public:
+    using clock = std::chrono::steady_clock;
+
+    JobQueue() {
+        budgets[static_cast<size_t>(Priority::High)] = std::chrono::milliseconds(1);
+        budgets[static_cast<size_t>(Priority::Normal)] = std::chrono::milliseconds(100);
+        budgets[static_cast<size_t>(Priority::Low)] = std::chrono::seconds(10);
+    }
+
+    // бюджет очікування класу, тобто відносний дедлайн його завдань
+    void set_budget(Priority priority, clock::duration budget) {
+        budgets[static_cast<size_t>(priority)] = budget;
+    }
+
+    clock::duration budget(Priority priority) const {
+        return budgets[static_cast<size_t>(priority)];
+    }
+
+    void push(Job job, Priority priority, clock::time_point now) {
+        job.set_submit_time(now);
+        Level& level = levels[static_cast<size_t>(priority)];
+        level.items.push_back(QueuedJob{std::move(job), now, now + budgets[static_cast<size_t>(priority)], priority, next_seq++, false});
+        ++count;
+    }
+
+    // завдання з явним дедлайном; pinned — завдання, яке evict() не чіпає
+    void push(Job job, Priority priority, clock::time_point now, clock::time_point deadline, bool pinned = false) {
+        job.set_submit_time(now);
+        deadlines.push_back(QueuedJob{std::move(job), now, deadline, priority, next_seq++, pinned});
+        std::push_heap(deadlines.begin(), deadlines.end(), later);
+        ++count;
+    }
+
+    // забирає завдання з найближчим дедлайном
+    bool pop(QueuedJob& out) {
+        if (count == 0)
+            return false;
+
+        QueuedJob* best = nullptr;
+        Level* best_level = nullptr;
+        for (auto &level : levels) {
+            if (level.head == level.items.size())
+                continue;
+            QueuedJob& head = level.items[level.head];
+            if (!best || later(*best, head)) {
+                best = &head;
+                best_level = &level;
+            }
+        }
+        if (!deadlines.empty() && (!best || later(*best, deadlines.front()))) {
+            std::pop_heap(deadlines.begin(), deadlines.end(), later);
+            out = std::move(deadlines.back());
+            deadlines.pop_back();
+        } else {
+            out = std::move(*best);
+            // повністю вичерпаний рівень очищається, зберігаючи місткість вектора
+            if (++best_level->head == best_level->items.size()) {
+                best_level->items.clear();
+                best_level->head = 0;
+            }
+        }
+        --count;
+        return true;
+    }
+
+    // витіснення під перевантаженням: забирає найстаріше завдання найменш термінового класу,
+    // не терміновішого за incoming (завдання з явним дедлайном — за своїм класом);
+    // false — витіснити нічого, усі завдання буфера терміновіші за нове
+    bool evict(Priority incoming, QueuedJob& out) {
+        for (size_t p = NUM_PRIORITIES; p-- > static_cast<size_t>(incoming);) {
+            Level& level = levels[p];
+            const QueuedJob* oldest = level.head < level.items.size() ? &level.items[level.head] : nullptr;
+            size_t heap_index = deadlines.size();
+            for (size_t i = 0; i < deadlines.size(); ++i) {
+                if (static_cast<size_t>(deadlines[i].priority) != p || deadlines[i].pinned)
+                    continue;
+                if (!oldest || deadlines[i].seq < oldest->seq) {
+                    oldest = &deadlines[i];
+                    heap_index = i;
+                }
+            }
+            if (!oldest)
+                continue;
+            if (heap_index < deadlines.size()) {
+                out = std::move(deadlines[heap_index]);
+                deadlines[heap_index] = std::move(deadlines.back());
+                deadlines.pop_back();
+                std::make_heap(deadlines.begin(), deadlines.end(), later);
+            } else {
+                out = std::move(level.items[level.head]);
+                if (++level.head == level.items.size()) {
+                    level.items.clear();
+                    level.head = 0;
+                }
+            }
+            --count;
+            return true;
+        }
+        return false;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+private:
+    struct Level {
+        std::vector<QueuedJob> items;
+        size_t head = 0;
+    };
+
+    Level levels[NUM_PRIORITIES];
+    std::vector<QueuedJob> deadlines; // купа завдань з явним дедлайном (на вершині — найближчий)
+    clock::duration budgets[NUM_PRIORITIES];
+    size_t count = 0;
+    uint64_t next_seq = 0;
+
+    static bool later(const QueuedJob& a, const QueuedJob& b) {
+        if (a.deadline != b.deadline)
+            return a.deadline > b.deadline;
+        return a.seq > b.seq;
+    }
+};
+
+#endif // JOB_QUEUE_HPP
@@ -0,0 +1,306 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cpu.hpp"
+#include "histogram.hpp"
+
+#ifdef __unix__
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// лічильник подій з довільних потоків: SLOTS окремих кеш-ліній, кожен потік пише у свій слот
+// (за номером, виданим при першому зверненні), тож відправники не б'ються за одну лінію;
+// сума слотів збирається під час читання
+class StripedCounter {
+public:
+    static constexpr size_t SLOTS = 16;
+
+    void add(uint64_t n = 1) {
+        slots[slot_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const {
+        uint64_t total = 0;
+        for (auto &slot : slots)
+            total += slot.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+
+    Slot slots[SLOTS];
+
+    static size_t slot_index() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+        return index;
+    }
+};
+
+// показники одного робітника на момент знімка
+struct WorkerMetrics {
+    size_t id = 0;
+    size_t node = 0;
+    bool running = false;
+    uint64_t executed = 0; // виконані завдання (з каналу, локального деку й украдені)
+    uint64_t failed = 0; // з них завершилися винятком
+    uint64_t steals = 0; // завдання, взяті з деків інших робітників або каналів інших вузлів
+    uint64_t parks = 0; // скільки разів робітник засинав без роботи
+    uint64_t busy_ns = 0; // сумарний час виконання завдань
+    uint64_t idle_ns = 0; // сумарний час очікування на завдання (без поточного очікування)
+};
+
+// знімок показників пулу; збирається без блокувань з лічильників робітників, планувальника та каналів,
+// тож окремі поля можуть трохи розходитися між собою (наприклад, submitted і executed)
+struct MetricsSnapshot {
+    uint64_t submitted = 0; // завдання, передані в пул (execute/submit/продовження і спрацювання таймерів)
+    uint64_t executed = 0;
+    uint64_t failed = 0;
+    uint64_t steals = 0;
+    uint64_t parks = 0;
+    // допуск у буфер планувальника (див. AdmissionLimits)
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+    uint64_t dropped = 0;
+    uint64_t caller_runs = 0;
+    // глибина черг
+    size_t workers = 0;
+    size_t buffer_jobs = 0;
+    size_t buffer_bytes = 0;
+    size_t channel_jobs = 0;
+    size_t timers = 0;
+    // перенесення планувальника: розмір пакету (завдань) і тривалість (нс)
+    LatencySnapshot flush_size;
+    LatencySnapshot flush_time;
+    LatencySnapshot queue_wait;
+    LatencySnapshot execution;
+    std::vector<WorkerMetrics> per_worker;
+};
+
+// текстовий формат експозиції Prometheus (версія 0.0.4)
+inline std::string to_prometheus(const MetricsSnapshot& snap, const std::string& prefix = "threadpool") {
+    std::ostringstream out;
+    out.precision(12);
+    auto header = [&](const char* name, const char* type, const char* help) {
+        out << "# HELP " << prefix << '_' << name << ' ' << help << '\n';
+        out << "# TYPE " << prefix << '_' << name << ' ' << type << '\n';
+    };
+    auto metric = [&](const char* name, const char* type, const char* help, auto value) {
+        header(name, type, help);
+        out << prefix << '_' << name << ' ' << value << '\n';
+    };
+    // гістограми пулу експортуються як summary з перцентилями
+    auto summary = [&](const char* name, const char* help, const LatencySnapshot& s, double scale) {
+        header(name, "summary", help);
+        out << prefix << '_' << name << "{quantile=\"0.5\"} " << s.p50 * scale << '\n';
+        out << prefix << '_' << name << "{quantile=\"0.99\"} " << s.p99 * scale << '\n';
+        out << prefix << '_' << name << "{quantile=\"0.999\"} " << s.p999 * scale << '\n';
+        out << prefix << '_' << name << "_sum " << s.mean * s.count * scale << '\n';
+        out << prefix << '_' << name << "_count " << s.count << '\n';
+    };
+    auto per_worker = [&](const char* name, const char* type, const char* help, auto field) {
+        header(name, type, help);
+        for (auto &w : snap.per_worker)
+            out << prefix << '_' << name << "{worker=\"" << w.id << "\",node=\"" << w.node << "\"} " << field(w) << '\n';
+    };
+
+    metric("jobs_submitted_total", "counter", "Jobs submitted to the pool.", snap.submitted);
+    metric("jobs_completed_total", "counter", "Jobs executed by workers.", snap.executed);
+    metric("jobs_failed_total", "counter", "Jobs that finished with an exception.", snap.failed);
+    metric("jobs_accepted_total", "counter", "Jobs admitted to the scheduler buffer.", snap.accepted);
+    metric("jobs_rejected_total", "counter", "Jobs rejected by admission control.", snap.rejected);
+    metric("jobs_dropped_total", "counter", "Queued jobs evicted by the drop-oldest policy.", snap.dropped);
+    metric("jobs_caller_runs_total", "counter", "Jobs run on the submitting thread by the caller-runs policy.", snap.caller_runs);
+    metric("steals_total", "counter", "Jobs taken from other workers or other NUMA nodes.", snap.steals);
+    metric("parks_total", "counter", "Times a worker went to sleep without work.", snap.parks);
+    metric("workers", "gauge", "Running workers.", snap.workers);
+    metric("buffer_jobs", "gauge", "Jobs waiting in the scheduler buffer.", snap.buffer_jobs);
+    metric("buffer_bytes", "gauge", "Approximate memory of jobs in the scheduler buffer.", snap.buffer_bytes);
+    metric("channel_jobs", "gauge", "Jobs waiting in worker channels.", snap.channel_jobs);
+    metric("timers", "gauge", "Pending timers.", snap.timers);
+    summary("flush_size_jobs", "Jobs moved by one scheduler flush.", snap.flush_size, 1.0);
+    summary("flush_duration_seconds", "Duration of one scheduler flush.", snap.flush_time, 1e-9);
+    summary("queue_wait_seconds", "Time from submission to start of execution.", snap.queue_wait, 1e-9);
+    summary("execution_seconds", "Job execution time.", snap.execution, 1e-9);
+    per_worker("worker_jobs_completed_total", "counter", "Jobs executed by the worker.", [](const WorkerMetrics& w) { return w.executed; });
+    per_worker("worker_busy_seconds_total", "counter", "Time the worker spent executing jobs.", [](const WorkerMetrics& w) { return w.busy_ns * 1e-9; });
+    per_worker("worker_idle_seconds_total", "counter", "Time the worker spent waiting for jobs.", [](const WorkerMetrics& w) { return w.idle_ns * 1e-9; });
+    per_worker("worker_steals_total", "counter", "Jobs stolen by the worker.", [](const WorkerMetrics& w) { return w.steals; });
+    per_worker("worker_parks_total", "counter", "Times the worker went to sleep.", [](const WorkerMetrics& w) { return w.parks; });
+    per_worker("worker_running", "gauge", "Whether the worker thread is running.", [](const WorkerMetrics& w) { return w.running ? 1 : 0; });
+    return out.str();
+}
+
+// куди MetricsExporter віддає показники: File — файл, що перезаписується кожен interval
+// (атомарно через тимчасовий файл і rename, тож читач не побачить половину), UnixSocket —
+// локальний сокет, кожне підключення до якого отримує свіжий знімок і закривається
+enum class ExportTarget {
+    File,
+    UnixSocket
+};
+
+struct ExporterOptions {
+    ExportTarget target = ExportTarget::File;
+    std::string path;
+    std::chrono::milliseconds interval{1000}; // період запису файлу
+    std::string prefix = "threadpool";
+};
+
+// фоновий потік експорту показників у текстовому форматі Prometheus
+class MetricsExporter {
+public:
+    MetricsExporter(std::function<MetricsSnapshot()> source, ExporterOptions options)
+        : source(std::move(source))
+        , options(std::move(options))
+    {
+        if (this->options.target == ExportTarget::UnixSocket)
+            listen_fd = open_socket(this->options.path);
+        thread = std::thread([this]() { run(); });
+    }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    ~MetricsExporter() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cond.notify_all();
+        if (thread.joinable())
+            thread.join();
+#ifdef __unix__
+        if (listen_fd >= 0) {
+            ::close(listen_fd);
+            ::unlink(options.path.c_str());
+        }
+#endif
+    }
+
+    // чи вдалося відкрити сокет (для File завжди true)
+    bool is_open() const {
+        return options.target == ExportTarget::File || listen_fd >= 0;
+    }
+
+private:
+    // як часто потік сокета перевіряє прапорець зупинки
+    static constexpr int POLL_MS = 100;
+    // скільки відправка знімка чекає на клієнта, що не читає, перш ніж закрити з'єднання
+    static constexpr int SEND_TIMEOUT_MS = 1000;
+
+    std::function<MetricsSnapshot()> source;
+    ExporterOptions options;
+    int listen_fd = -1;
+    std::thread thread;
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool stopping = false;
+
+    bool stop_requested() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return stopping;
+    }
+
+    void run() {
+        if (options.target == ExportTarget::UnixSocket) {
+            serve();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mtx);
+        do {
+            lock.unlock();
+            write_file();
+            lock.lock();
+        } while (!cond.wait_for(lock, options.interval, [this]() { return stopping; }));
+        // останній знімок після зупинки
+        lock.unlock();
+        write_file();
+    }
+
+    void write_file() {
+        std::string text = to_prometheus(source(), options.prefix);
+        std::string tmp = options.path + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "w");
+        if (!f)
+            return;
+        bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+        ok = std::fclose(f) == 0 && ok;
+        if (ok)
+            std::rename(tmp.c_str(), options.path.c_str());
+    }
+
+#ifdef __unix__
+    static int open_socket(const std::string& path) {
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+            return -1;
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        addr.sun_family = AF_UNIX;
+        path.copy(addr.sun_path, path.size());
+        // видаляється лише сокет, що лишився від попереднього запуску; інший файл за цим шляхом
+        // не чіпаємо, і тоді bind() не вдасться
+        struct stat st;
+        if (::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+            ::unlink(path.c_str());
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 8) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void serve() {
+        if (listen_fd < 0)
+            return;
+        while (!stop_requested()) {
+            pollfd pfd{listen_fd, POLLIN, 0};
+            if (::poll(&pfd, 1, POLL_MS) <= 0)
+                continue;
+            int client = ::accept(listen_fd, nullptr, nullptr);
+            if (client < 0)
+                continue;
+            // клієнт, що не читає, не блокує потік (а з ним і деструктор пулу) довше за тайм-аут
+            timeval timeout{SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000};
+            ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            std::string text = to_prometheus(source(), options.prefix);
+            for (size_t sent = 0; sent < text.size() && !stop_requested();) {
+                ssize_t n = ::send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    break;
+                sent += static_cast<size_t>(n);
+            }
+            ::close(client);
+        }
+    }
+#else
+    static int open_socket(const std::string&) {
+        return -1;
+    }
+
+    void serve() {
+    }
+#endif
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,146 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "threadpool.hpp"
+
+namespace parallel_detail {
+
+// спільний стан одного виклику parallel_for / parallel_reduce:
+// шматки діапазону роздаються через атомарний лічильник next, тому кожен помічник
+// (і сам викликач) забирає наступний вільний шматок, поки вони не закінчаться
+template <typename Body>
+struct ChunkState {
+    ChunkState(size_t chunks, Body body)
+        : chunks(chunks)
+        , body(std::move(body))
+    {
+    }
+
+    const size_t chunks;
+    Body body;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mtx;
+    std::condition_variable cond;
+
+    void work() {
+        while (true) {
+            size_t chunk = next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunks)
+                return;
+            // після першого винятку решта шматків лише позначається виконаною
+            // шматок, який обробляє викликач, не змінює job_failed_flag() його завдання
+            if (!failed.load(std::memory_order_relaxed)) {
+                JobFailedScope scope;
+                try {
+                    body(chunk);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                }
+            }
+            if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(mtx);
+                cond.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this]() { return done.load(std::memory_order_acquire) == chunks; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// виконує body(chunk) для chunk у [0, chunks): помічники ставляться в пул одним execute_bulk,
+// а викликач сам обробляє шматки, тож виклик не блокується, навіть якщо пул зайнятий
+// або викликач сам є робітником цього пулу
+template <typename Body>
+void run_chunks(ThreadPool& pool, size_t chunks, Body body) {
+    if (chunks == 0)
+        return;
+    auto state = std::make_shared<ChunkState<Body>>(chunks, std::move(body));
+
+    size_t helpers = std::min(pool.size(), chunks - 1);
+    if (helpers > 0) {
+        std::vector<Job> jobs;
+        jobs.reserve(helpers);
+        for (size_t i = 0; i < helpers; ++i)
+            jobs.emplace_back([state]() { state->work(); });
+        pool.execute_bulk(std::move(jobs));
+    }
+
+    state->work();
+    state->wait();
+}
+
+} // namespace parallel_detail
+
+// автоматичний розмір шматка: близько чотирьох шматків на робітника
+inline size_t auto_grain(size_t count, size_t workers) {
+    size_t chunks = std::max<size_t>(1, workers) * 4;
+    return std::max<size_t>(1, (count + chunks - 1) / chunks);
+}
+
+// parallel_for(): викликає fn(i) для кожного i з [begin, end), розбиваючи діапазон на шматки по grain
+// елементів (grain == 0 — автоматично); перший виняток з fn перекидається викликачу
+template <typename Index, typename Fn>
+void parallel_for(ThreadPool& pool, Index begin, Index end, size_t grain, Fn fn) {
+    if (end <= begin)
+        return;
+    size_t count = static_cast<size_t>(end - begin);
+    if (grain == 0)
+        grain = auto_grain(count, pool.size());
+    size_t chunks = (count + grain - 1) / grain;
+
+    parallel_detail::run_chunks(pool, chunks, [begin, end, grain, &fn](size_t chunk) {
+        Index lo = begin + static_cast<Index>(chunk * grain);
+        // lo + grain може переповнити Index біля його верхньої межі
+        Index hi = static_cast<size_t>(end - lo) > grain ? lo + static_cast<Index>(grain) : end;
+        for (Index i = lo; i < hi; ++i)
+            fn(i);
+    });
+}
+
+// parallel_reduce(): обчислює reduce(...reduce(identity, map(begin))..., map(end - 1))
+// кожен шматок згортається локально, а часткові результати поєднуються в порядку шматків,
+// тож для асоціативного reduce результат не залежить від розкладу виконання
+template <typename Index, typename T, typename Map, typename Reduce>
+T parallel_reduce(ThreadPool& pool, Index begin, Index end, size_t grain, T identity, Map map, Reduce reduce) {
+    if (end <= begin)
+        return identity;
+    size_t count = static_cast<size_t>(end - begin);
+    if (grain == 0)
+        grain = auto_grain(count, pool.size());
+    size_t chunks = (count + grain - 1) / grain;
+
+    std::vector<T> partial(chunks, identity);
+    parallel_detail::run_chunks(pool, chunks, [begin, end, grain, &identity, &map, &reduce, &partial](size_t chunk) {
+        Index lo = begin + static_cast<Index>(chunk * grain);
+        Index hi = static_cast<size_t>(end - lo) > grain ? lo + static_cast<Index>(grain) : end;
+        T acc = identity;
+        for (Index i = lo; i < hi; ++i)
+            acc = reduce(std::move(acc), map(i));
+        partial[chunk] = std::move(acc);
+    });
+
+    T result = std::move(identity);
+    for (auto &value : partial)
+        result = reduce(std::move(result), std::move(value));
+    return result;
+}
+
+#endif // PARALLEL_HPP
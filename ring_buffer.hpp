@@ -0,0 +1,136 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include "cpu.hpp"
+
+// обмежена lock-free черга MPMC (схема Вюкова з порядковими номерами в комірках)
+// кожна комірка зберігає sequence: якщо sequence == pos, комірка вільна для запису,
+// якщо sequence == pos + 1, у ній лежить елемент, готовий до читання
+template <typename T>
+class RingBuffer {
+public:
+    // місткість округлюється вгору до степеня двійки, щоб індекс рахувався маскою
+    explicit RingBuffer(size_t capacity)
+        : mask(round_up(capacity) - 1)
+        , cells(new Cell[mask + 1])
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueue_pos.store(0, std::memory_order_relaxed);
+        dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // знищення елементів, що залишились у буфері
+    ~RingBuffer() {
+        size_t head = dequeue_pos.load(std::memory_order_relaxed);
+        size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            cells[head & mask].ptr()->~T();
+        }
+    }
+
+    // спроба додати елемент; якщо буфер повний, повертає false і не чіпає t
+    bool try_push(T&& t) {
+        return emplace(std::move(t));
+    }
+
+    bool try_push(const T& t) {
+        return emplace(t);
+    }
+
+    // спроба забрати елемент; якщо буфер порожній, повертає false
+    bool try_pop(T& out) {
+        Cell* cell;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // порожньо
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        T* value = cell->ptr();
+        out = std::move(*value);
+        value->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // приблизна кількість елементів (точна лише за відсутності конкурентних операцій)
+    size_t size() const {
+        size_t tail = enqueue_pos.load(std::memory_order_acquire);
+        size_t head = dequeue_pos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool is_empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* ptr() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    // позиції запису та читання рознесені по різних кеш-лініях
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_pos;
+
+    template <typename U>
+    bool emplace(U&& u) {
+        Cell* cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // повно
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::forward<U>(u));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    static size_t round_up(size_t n) {
+        size_t p = 2;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+};
+
+#endif // RING_BUFFER_HPP
@@ -1,15 +1,74 @@
 #ifndef SCHEDULER_HPP
 #define SCHEDULER_HPP
 
-#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <vector>
 #include <mutex>
 #include <functional>
+#include <iterator>
 #include <memory>
-#include <iostream>
 #include "channel.hpp"
+#include "histogram.hpp"
+#include "job.hpp"
+#include "job_queue.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
 
-// тип Job як функцію, що не приймає параметрів і повертає void.
-using Job = std::function<void()>;
+// тригери подієвого перенесення завдань з буфера в канал (див. Scheduler::wait_for_dispatch)
+struct DispatchTriggers {
+    size_t max_batch_size = 64; // перенесення, щойно в буфері набралося стільки завдань
+    std::chrono::microseconds max_latency{1000}; // перенесення, щойно найстаріше завдання чекає довше
+    bool flush_on_idle = true; // перенесення, щойно якийсь робітник залишився без роботи
+};
+
+// лічильники одного класу пріоритету: скільки завдань надійшло, скільки перенесено в канал
+// і скільки часу вони провели в буфері планувальника
+struct PriorityStats {
+    uint64_t scheduled = 0;
+    uint64_t dispatched = 0;
+    uint64_t dropped = 0; // витіснено політикою DropOldest
+    std::chrono::nanoseconds total_queue_time{0};
+    std::chrono::nanoseconds max_queue_time{0};
+};
+
+// що робить schedule(), коли буфер планувальника досяг меж AdmissionLimits
+enum class OverloadPolicy {
+    Block, // відправник чекає на місце не довше block_timeout, потім завдання відхиляється
+    RejectNewest, // нове завдання відхиляється
+    DropOldest, // витісняються найстаріші завдання найменш термінового класу, не терміновішого за нове (без них нове відхиляється)
+    CallerRuns // нове завдання виконується одразу в потоці відправника
+};
+
+// межі буфера планувальника (0 — без обмежень); відхилене або відкинуте завдання знищується
+// без виконання, тож Future з submit() отримує broken_promise; таймери в межі не входять,
+// а завдання, що чекають у чергах Strand, входять (див. Scheduler::reserve()); за заданих меж
+// execute() з робітника в режимі WorkStealing теж іде через буфер, а не в локальний дек;
+// продовження Future (then) займають місце свого батьківського завдання і в межі не входять
+struct AdmissionLimits {
+    size_t max_jobs = 0; // кількість завдань у буфері
+    size_t max_bytes = 0; // приблизний обсяг завдань у буфері (Job::footprint())
+    OverloadPolicy policy = OverloadPolicy::Block;
+    std::chrono::milliseconds block_timeout{100};
+    // межа довжини каналу бекенду Mutex між планувальником і робітниками (див. Channel::set_limit);
+    // повний канал гальмує перенесення, і тоді надлишок затримується в обмеженому буфері
+    size_t max_channel_jobs = 0;
+};
+
+// лічильники допуску завдань у буфер планувальника
+struct AdmissionStats {
+    uint64_t accepted = 0; // прийнято в буфер
+    uint64_t rejected = 0; // відхилено (повний буфер, минув block_timeout, try_schedule() або зупинка)
+    uint64_t dropped = 0; // витіснено з буфера політикою DropOldest
+    uint64_t caller_runs = 0; // виконано в потоці відправника (CallerRuns)
+    uint64_t blocked = 0; // скільки разів відправник чекав на місце (Block)
+    size_t queued_jobs = 0; // поточна глибина буфера (разом із чергами Strand, див. reserve())
+    size_t queued_bytes = 0;
+    size_t peak_jobs = 0;
+    size_t peak_bytes = 0;
+    size_t channel_jobs = 0; // глибина каналів (заповнює ThreadPool)
+};
 
 // приймає спільний вказівник на канал завдань
 // ініціалізує прапорець ready в true (планувальник готовий переносити завдання)
@@ -18,6 +77,10 @@ public:
     Scheduler(std::shared_ptr<Channel<Job>> channel)
         : channel(channel), ready(true) {}
 
+    // планувальник з подієвим перенесенням: потік планувальника чекає в wait_for_dispatch()
+    Scheduler(std::shared_ptr<Channel<Job>> channel, DispatchTriggers triggers)
+        : channel(channel), ready(true), event_driven(true), triggers(triggers) {}
+
     // метод pause() для призупинення перенесення завдань з буфера в канал
     // захищає доступ до прапорця ready за допомогою м'ютекса
     void pause() {
@@ -27,39 +90,385 @@ public:
 
     // метод unpause(): відновлює перенесення завдань, встановлюючи ready в true
     void unpause() {
-        std::lock_guard<std::mutex> lock(mtx);
-        ready = true;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ready = true;
+            dispatch_cond.notify_one();
+        }
+        // таймери, що настали під час паузи, мають спрацювати одразу
+        if (timer_wakeup)
+            timer_wakeup();
     }
 
     // метод run():перевірка на дозвіл перенесення завдання
+    // викликається лише з одного потоку (потоку планувальника)
+    // разом із буфером переносяться завдання таймерів, що вже настали (вони йдуть першими)
     uint64_t run() {
-        std::lock_guard<std::mutex> lock(mtx);
-        if (!ready)
-            return 0;
-        uint64_t size = buffer.size();
-        std::cout << "Running " << size << " jobs" << std::endl;
-
-        // перебираємо всі завдання у буфері та переміщаємо їх у канал
-        while (!buffer.empty()) {
-            // std::move для ефективного переміщення завдання без зайвого копіювання
-            Job job = std::move(buffer.front());
-            buffer.pop_front(); // видалення завдання з буфера після його вилучення
-            channel->send(std::move(job)); // передача завдання до каналу для подальшого виконання робітниками
+        uint64_t size;
+        auto started = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!ready)
+                return 0;
+            auto now = std::chrono::steady_clock::now();
+            collect_timers(now);
+            size = flush.size() + buffer.size();
+            TRACE_EVENT(Flush, size);
+
+            // вибираємо завдання з буфера в порядку найближчого дедлайну, тож у каналі (FIFO)
+            // робітники отримають спершу найтерміновіші
+            QueuedJob entry;
+            while (buffer.pop(entry)) {
+                queued_bytes -= entry.job.footprint();
+                PriorityStats& st = stats[static_cast<size_t>(entry.priority)];
+                auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.enqueued);
+                ++st.dispatched;
+                st.total_queue_time += waited;
+                st.max_queue_time = std::max(st.max_queue_time, waited);
+                flush.push_back(std::move(entry.job));
+            }
+            publish_depth();
+            if (space_waiters > 0)
+                space_cond.notify_all();
+        }
+
+        send_flush();
+        record_flush(started, size);
+        return size;
+    }
+
+    // переносить у канал лише завдання таймерів, що вже настали, не чіпаючи буфер
+    // (у пакетному режимі таймери спрацьовують між пакетами); повертає їх кількість
+    // викликається лише з потоку планувальника
+    uint64_t run_timers() {
+        uint64_t size;
+        auto started = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            timer_wake = std::chrono::steady_clock::time_point::min();
+            if (!ready)
+                return 0;
+            collect_timers(std::chrono::steady_clock::now());
+            size = flush.size();
+        }
+        if (size > 0) {
+            send_flush();
+            record_flush(started, size);
         }
         return size;
     }
 
-    // метод schedule(): додає нове завдання до внутрішнього буфера
+    // таймер: завдання потрапить у канал не раніше when; period > 0 — повтор через кожен period
+    // після завершення попереднього запуску (запуски одного таймера не перекриваються)
+    // на паузі таймери не спрацьовують: ті, що настали, переносяться після unpause()
+    TimerHandle schedule_at(std::chrono::steady_clock::time_point when, Job job,
+                            std::chrono::steady_clock::duration period = std::chrono::steady_clock::duration::zero()) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (closed)
+            return TimerHandle();
+        TimerHandle handle = timers.add(when, std::move(job), period);
+        counters.timers.store(timers.size(), std::memory_order_relaxed);
+        bool earlier = wake_for_timer(lock);
+        if (earlier && timer_wakeup)
+            timer_wakeup();
+        return handle;
+    }
+
+    // скасування таймера; false, якщо він уже спрацював (одноразовий) або вже скасований
+    bool cancel_timer(TimerHandle handle) {
+        std::lock_guard<std::mutex> lock(mtx);
+        bool cancelled = timers.cancel(handle);
+        counters.timers.store(timers.size(), std::memory_order_relaxed);
+        return cancelled;
+    }
+
+    // кількість таймерів, що очікують спрацювання (разом із періодичними)
+    size_t timer_count() const {
+        return counters.timers.load(std::memory_order_relaxed);
+    }
+
+    // скільки разів спрацювали таймери (кожен запуск періодичного — окремо); скасовані не рахуються
+    uint64_t timers_fired() const {
+        return counters.fired.load(std::memory_order_relaxed);
+    }
+
+    // найближча подія таймерів (time_point::max(), якщо таймерів немає або планувальник на паузі);
+    // потік планувальника викликає її перед сном, після чого новий раніший таймер його розбудить
+    std::chrono::steady_clock::time_point next_timer() {
+        std::lock_guard<std::mutex> lock(mtx);
+        timer_wake = ready ? timers.next_expiry() : std::chrono::steady_clock::time_point::max();
+        return timer_wake;
+    }
+
+    // сон потоку планувальника до until або до найближчого таймера;
+    // true — настав час таймерів (далі треба викликати run_timers()), false — настав until або interrupt()
+    bool wait_for_timers(std::chrono::steady_clock::time_point until) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            auto now = std::chrono::steady_clock::now();
+            auto next = ready ? timers.next_expiry() : std::chrono::steady_clock::time_point::max();
+            if (interrupted) {
+                timer_wake = std::chrono::steady_clock::time_point::min();
+                return false;
+            }
+            if (now >= next || now >= until) {
+                timer_wake = std::chrono::steady_clock::time_point::min();
+                return now >= next;
+            }
+            timer_wake = next;
+            dispatch_cond.wait_until(lock, std::min(next, until));
+        }
+    }
+
+    // виклик, коли новий таймер настає раніше, ніж планувальник збирався прокинутися
+    // (потрібен, якщо потік планувальника чекає не в wait_for_dispatch()/wait_for_timers());
+    // задається до запуску потоку планувальника
+    void set_timer_wakeup(std::function<void()> f) {
+        std::lock_guard<std::mutex> lock(mtx);
+        timer_wakeup = std::move(f);
+    }
+
+    // метод schedule(): додає нове завдання класу Normal до внутрішнього буфера
     // захищає доступ до буфера за допомогою м'ютекса
-    void schedule(Job job) {
+    // повертає false, якщо завдання відхилено (див. AdmissionLimits); CallerRuns виконує його тут же
+    bool schedule(Job job) {
+        return schedule(std::move(job), Priority::Normal);
+    }
+
+    // schedule() з класом пріоритету; дедлайн завдання = час надходження + бюджет класу
+    // завдання класу High у подієвому режимі переносяться в канал одразу
+    bool schedule(Job job, Priority priority) {
+        return enqueue(job, priority, true, [&](std::chrono::steady_clock::time_point now) {
+            buffer.push(std::move(job), priority, now);
+        });
+    }
+
+    // schedule() з явним дедлайном; клас priority використовується лише для лічильників
+    bool schedule(Job job, std::chrono::steady_clock::time_point deadline, Priority priority = Priority::Normal) {
+        return enqueue(job, priority, true, [&](std::chrono::steady_clock::time_point now) {
+            buffer.push(std::move(job), priority, now, deadline);
+        });
+    }
+
+    // try_schedule(): як schedule(), але без очікування і без виконання в потоці відправника:
+    // за повного буфера (крім політики DropOldest, якщо є що витіснити) завдання відхиляється і повертається false
+    bool try_schedule(Job job, Priority priority = Priority::Normal) {
+        return enqueue(job, priority, false, [&](std::chrono::steady_clock::time_point now) {
+            buffer.push(std::move(job), priority, now);
+        });
+    }
+
+    // метод schedule_batch(): додає всі завдання з jobs до буфера під одним захопленням м'ютекса
+    // пакет, що не вміщується в межі буфера, допускається по одному завданню
+    void schedule_batch(std::vector<Job>& jobs, Priority priority = Priority::Normal) {
+        if (jobs.empty())
+            return;
+        size_t bytes = 0;
+        for (auto &job : jobs)
+            bytes += job.footprint();
+        bool admitted = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!closed && fits(jobs.size(), bytes)) {
+                auto now = std::chrono::steady_clock::now();
+                bool was_empty = begin_push(now, priority, jobs.size());
+                for (auto &job : jobs)
+                    buffer.push(std::move(job), priority, now);
+                account(jobs.size(), bytes);
+                end_push(was_empty);
+                admitted = true;
+            }
+        }
+        if (!admitted) {
+            for (auto &job : jobs)
+                schedule(std::move(job), priority);
+        }
+        // відкинуті завдання знищуються поза м'ютексом: деструктор може знову звернутися до планувальника
+        jobs.clear();
+    }
+
+    // межі буфера та політика перевантаження
+    void set_admission(const AdmissionLimits& l) {
         std::lock_guard<std::mutex> lock(mtx);
-        buffer.push_back(std::move(job));
+        limits = l;
+        limited.store(l.max_jobs > 0 || l.max_bytes > 0, std::memory_order_relaxed);
+        space_cond.notify_all();
     }
 
-    // метод size(): повертає поточну кількість завдань, що знаходяться в буфері
-    size_t size() {
+    // чи задано межі буфера; без них reserve() не потрібен (читається без м'ютекса)
+    bool has_limits() const {
+        return limited.load(std::memory_order_relaxed);
+    }
+
+    // завдання, що чекають поза буфером (у чергах Strand), займають місце в тих самих межах:
+    // reserve() застосовує до завдання обсягом bytes політику перевантаження і за успіху тримає
+    // місце до release(); завдання черги не можна виконати поза її порядком, тож CallerRuns
+    // тут діє як Block; false — завдання відхилено
+    bool reserve(size_t bytes) {
+        std::vector<Job> evicted; // знищуються після звільнення м'ютекса
+        std::unique_lock<std::mutex> lock(mtx);
+        OverloadPolicy policy = limits.policy == OverloadPolicy::CallerRuns ? OverloadPolicy::Block : limits.policy;
+        if (admit(lock, policy, Priority::Normal, bytes, true, evicted) != Admit::Push)
+            return false;
+        ++reserved_jobs;
+        reserved_bytes += bytes;
+        bump(counters.accepted);
+        publish_depth();
+        return true;
+    }
+
+    // завдання, місце для якого вже враховано через reserve() (осушувач черги Strand): допускається
+    // без перевірки меж і не витісняється політикою DropOldest; false — планувальник закрито
+    bool schedule_reserved(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!closed) {
+                auto now = std::chrono::steady_clock::now();
+                size_t bytes = job.footprint();
+                bool was_empty = begin_push(now, Priority::Normal);
+                buffer.push(std::move(job), Priority::Normal, now, now + buffer.budget(Priority::Normal), true);
+                queued_bytes += bytes;
+                publish_depth();
+                end_push(was_empty);
+                return true;
+            }
+        }
+        // знищення поза м'ютексом (див. schedule_batch)
+        return false;
+    }
+
+    void release(size_t bytes) {
         std::lock_guard<std::mutex> lock(mtx);
-        return buffer.size();
+        --reserved_jobs;
+        reserved_bytes -= bytes;
+        publish_depth();
+        if (space_waiters > 0)
+            space_cond.notify_all();
+    }
+
+    // лічильники допуску і поточна глибина буфера (без блокування)
+    AdmissionStats admission_stats() const {
+        AdmissionStats result;
+        result.accepted = counters.accepted.load(std::memory_order_relaxed);
+        result.rejected = counters.rejected.load(std::memory_order_relaxed);
+        result.dropped = counters.dropped.load(std::memory_order_relaxed);
+        result.caller_runs = counters.caller_runs.load(std::memory_order_relaxed);
+        result.blocked = counters.blocked.load(std::memory_order_relaxed);
+        result.queued_jobs = counters.jobs.load(std::memory_order_relaxed);
+        result.queued_bytes = counters.bytes.load(std::memory_order_relaxed);
+        result.peak_jobs = counters.peak_jobs.load(std::memory_order_relaxed);
+        result.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    // розміри (у завданнях) і тривалість (нс) перенесень; пише лише потік планувальника
+    const LatencyHistogram& flush_sizes() const {
+        return flush_size_hist;
+    }
+
+    const LatencyHistogram& flush_times() const {
+        return flush_time_hist;
+    }
+
+    // приймач перенесених завдань замість каналу (наприклад, розподіл між каналами вузлів NUMA);
+    // отримує завдання в порядку дедлайнів і має забрати їх з вектора
+    // задається до запуску потоку планувальника: run() читає його без м'ютекса
+    void set_sink(std::function<void(std::vector<Job>&)> s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        sink = std::move(s);
+    }
+
+    // бюджет очікування класу пріоритету (див. JobQueue)
+    void set_priority_budget(Priority priority, std::chrono::steady_clock::duration budget) {
+        std::lock_guard<std::mutex> lock(mtx);
+        buffer.set_budget(priority, budget);
+    }
+
+    // лічильники класу пріоритету
+    PriorityStats priority_stats(Priority priority) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return stats[static_cast<size_t>(priority)];
+    }
+
+    // метод wait_for_dispatch(): блокує потік планувальника, доки не спрацює один із тригерів:
+    // розмір буфера, дедлайн найстарішого завдання, сигнал бездіяльного робітника або таймер
+    // поки планувальник на паузі, тригери ігноруються; повертає false після interrupt()
+    bool wait_for_dispatch() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!interrupted) {
+            auto now = std::chrono::steady_clock::now();
+            auto next = ready ? timers.next_expiry() : std::chrono::steady_clock::time_point::max();
+            if (now >= next)
+                break;
+            timer_wake = next;
+            if (!ready || buffer.empty()) {
+                if (next == std::chrono::steady_clock::time_point::max())
+                    dispatch_cond.wait(lock);
+                else
+                    dispatch_cond.wait_until(lock, next);
+                continue;
+            }
+            if (buffer.size() >= triggers.max_batch_size || (triggers.flush_on_idle && idle_pending) || urgent_pending)
+                break;
+            auto deadline = oldest_time + triggers.max_latency;
+            if (now >= deadline)
+                break;
+            dispatch_cond.wait_until(lock, std::min(deadline, next));
+        }
+        timer_wake = std::chrono::steady_clock::time_point::min();
+        idle_pending = false;
+        urgent_pending = false;
+        return !interrupted;
+    }
+
+    // метод notify_idle(): робітник повідомляє, що канал порожній і він засинає
+    void notify_idle() {
+        std::lock_guard<std::mutex> lock(mtx);
+        idle_pending = true;
+        if (!buffer.empty())
+            dispatch_cond.notify_one();
+    }
+
+    // закриття перед зупинкою пулу: нові завдання й таймери, а також таймери, що очікують,
+    // відкидаються (їхні Future отримують broken_promise), а пауза знімається,
+    // тож останній run() переносить у канал усе, що лишилося в буфері
+    void close() {
+        std::vector<Job> dropped; // знищуються після звільнення м'ютекса
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        ready = true;
+        timers.clear(dropped);
+        counters.timers.store(timers.size(), std::memory_order_relaxed);
+        space_cond.notify_all();
+    }
+
+    // відкидає завдання з буфера, не передаючи їх робітникам; повертає їх кількість
+    size_t discard() {
+        std::vector<QueuedJob> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            QueuedJob entry;
+            while (buffer.pop(entry))
+                dropped.push_back(std::move(entry));
+            queued_bytes = 0;
+            publish_depth();
+            space_cond.notify_all();
+        }
+        // знищення поза м'ютексом (див. schedule_batch)
+        return dropped.size();
+    }
+
+    // метод interrupt(): виводить потік планувальника з wait_for_dispatch() і wait_for_timers()
+    void interrupt() {
+        std::lock_guard<std::mutex> lock(mtx);
+        interrupted = true;
+        dispatch_cond.notify_all();
+    }
+
+    // метод size(): повертає поточну кількість завдань, що знаходяться в буфері
+    // читається без блокування, тож може трохи відставати від відправників
+    size_t size() const {
+        return counters.jobs.load(std::memory_order_relaxed);
     }
 
     // метод is_empty(): перевіряє, чи буфер завдань порожній
@@ -69,10 +478,265 @@ public:
     }
 
 private:
-    std::deque<Job> buffer; // внутрішній буфер для накопичення завдань, які очікують виконання
+    JobQueue buffer; // внутрішній буфер для накопичення завдань, які очікують виконання (EDF за класами пріоритету)
+    std::vector<Job> flush; // завдання поточного перенесення в порядку дедлайнів
+    PriorityStats stats[NUM_PRIORITIES]; // лічильники за класами пріоритету
     std::mutex mtx; // м'ютекс для синхронізації доступу до буфера та прапорця ready
     std::shared_ptr<Channel<Job>> channel; // канал, куди будуть відправлятися завдання для виконання робітниками
+    std::function<void(std::vector<Job>&)> sink; // якщо задано, завдання передаються йому замість channel
     bool ready; // прапорець, що визначає, чи дозволено переносити завдання 
+
+    // стан подієвого режиму
+    bool event_driven = false;
+    DispatchTriggers triggers;
+    std::condition_variable dispatch_cond; // будить потік планувальника при спрацюванні тригера
+    std::chrono::steady_clock::time_point oldest_time; // час надходження найстарішого завдання в буфері
+    bool idle_pending = false; // з моменту останнього перенесення якийсь робітник залишився без роботи
+    bool urgent_pending = false; // у буфері є завдання класу High
+    bool interrupted = false;
+    bool closed = false; // пул зупиняється: нові завдання відкидаються
+
+    // допуск завдань у буфер
+    AdmissionLimits limits;
+    std::atomic<bool> limited{false}; // limits задає max_jobs або max_bytes
+    size_t queued_bytes = 0; // сума Job::footprint() завдань у буфері
+    size_t reserved_jobs = 0; // місце, зайняте через reserve()
+    size_t reserved_bytes = 0;
+
+    // лічильники для читання без блокування: змінюються лише під mtx (тож досить load + store)
+    // і лежать в окремих кеш-лініях, щоб читачі не смикали лінію м'ютекса й буфера
+    struct alignas(CACHE_LINE_SIZE) Counters {
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> caller_runs{0};
+        std::atomic<uint64_t> blocked{0};
+        std::atomic<size_t> jobs{0}; // глибина буфера
+        std::atomic<size_t> bytes{0};
+        std::atomic<size_t> peak_jobs{0};
+        std::atomic<size_t> peak_bytes{0};
+        std::atomic<size_t> timers{0};
+        std::atomic<uint64_t> fired{0}; // спрацювання таймерів (див. timers_fired())
+    } counters;
+    LatencyHistogram flush_size_hist;
+    LatencyHistogram flush_time_hist;
+    std::condition_variable space_cond; // будить відправників, що чекають на місце (Block)
+    size_t space_waiters = 0;
+
+    // таймери; колесо змінюється під mtx
+    TimerWheel timers;
+    std::vector<TimerHandle> periodic; // періодичні таймери, що спрацювали під час collect_timers()
+    // до якого часу спить потік планувальника (min — не спить, тож сам побачить нові таймери)
+    std::chrono::steady_clock::time_point timer_wake = std::chrono::steady_clock::time_point::min();
+    std::function<void()> timer_wakeup;
+
+    // відправка flush у приймач або канал однією пакетною відправкою
+    // (одне захоплення м'ютекса каналу і не більше size пробуджень робітників)
+    // відправка йде поза м'ютексом: у повному кільці LockFreeRing відправник паркується, поки
+    // робітники не звільнять місце, а вони самі можуть чекати на цей м'ютекс у notify_idle()
+    void send_flush() {
+        if (sink)
+            sink(flush);
+        else
+            channel->send_bulk(std::make_move_iterator(flush.begin()), std::make_move_iterator(flush.end()));
+        // очищення; місткість вектора зберігається, тож наступні перенесення не виділяють пам'ять
+        flush.clear();
+    }
+
+    // завдання таймерів, що настали до now, додаються у flush (викликається під mtx);
+    // періодичний таймер передається обгорткою, яка виконує завдання, що лишається у вузлі колеса
+    void collect_timers(std::chrono::steady_clock::time_point now) {
+        if (closed)
+            return;
+        size_t first = flush.size();
+        timers.advance(now, flush, periodic);
+        counters.timers.store(timers.size(), std::memory_order_relaxed);
+        for (auto handle : periodic)
+            flush.push_back(Job([this, handle]() { run_periodic(handle); }));
+        periodic.clear();
+        for (size_t i = first; i < flush.size(); ++i)
+            flush[i].set_submit_time(now);
+        if (flush.size() > first)
+            bump(counters.fired, flush.size() - first);
+    }
+
+    // запуск періодичного таймера на робітнику і повернення в колесо після завершення (навіть з винятком)
+    void run_periodic(TimerHandle handle) {
+        struct Rearm {
+            Scheduler* self;
+            TimerHandle handle;
+
+            ~Rearm() {
+                std::unique_lock<std::mutex> lock(self->mtx);
+                self->timers.rearm(handle);
+                self->counters.timers.store(self->timers.size(), std::memory_order_relaxed);
+                bool earlier = self->wake_for_timer(lock);
+                if (earlier && self->timer_wakeup)
+                    self->timer_wakeup();
+            }
+        };
+
+        Job* job;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            job = timers.running_job(handle);
+        }
+        if (!job)
+            return;
+        Rearm rearm{this, handle};
+        (*job)();
+    }
+
+    // будить потік планувальника, якщо найближчий таймер тепер раніший, ніж той збирався прокинутися;
+    // true — треба також викликати timer_wakeup (lock при цьому звільняється)
+    bool wake_for_timer(std::unique_lock<std::mutex>& lock) {
+        auto next = timers.next_expiry();
+        if (next >= timer_wake)
+            return false;
+        timer_wake = next;
+        dispatch_cond.notify_one();
+        lock.unlock();
+        return true;
+    }
+
+    // рішення щодо одного завдання, яке не вміщується в буфер
+    enum class Admit {
+        Push,
+        Reject,
+        RunHere
+    };
+
+    // чи вміщуються count завдань обсягом bytes; одне завдання, більше за max_bytes,
+    // допускається в порожній буфер, інакше воно не пройшло б ніколи
+    bool fits(size_t count, size_t bytes) const {
+        if (limits.max_jobs > 0 && buffer.size() + reserved_jobs + count > limits.max_jobs)
+            return false;
+        if (limits.max_bytes > 0 && queued_bytes + reserved_bytes + bytes > limits.max_bytes)
+            return count == 1 && buffer.empty() && reserved_jobs == 0;
+        return true;
+    }
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    // глибина буфера (разом із місцем, зайнятим через reserve()) для читачів без м'ютекса
+    // викликається під mtx після кожної зміни буфера
+    void publish_depth() {
+        size_t jobs = buffer.size() + reserved_jobs;
+        size_t bytes = queued_bytes + reserved_bytes;
+        counters.jobs.store(jobs, std::memory_order_relaxed);
+        counters.bytes.store(bytes, std::memory_order_relaxed);
+        if (jobs > counters.peak_jobs.load(std::memory_order_relaxed))
+            counters.peak_jobs.store(jobs, std::memory_order_relaxed);
+        if (bytes > counters.peak_bytes.load(std::memory_order_relaxed))
+            counters.peak_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    void account(size_t count, size_t bytes) {
+        bump(counters.accepted, count);
+        queued_bytes += bytes;
+        publish_depth();
+    }
+
+    void record_flush(std::chrono::steady_clock::time_point started, uint64_t size) {
+        if (size == 0)
+            return;
+        flush_size_hist.record(size);
+        flush_time_hist.record(std::chrono::steady_clock::now() - started);
+    }
+
+    // застосування політики перевантаження (під lock); витіснені завдання переносяться в evicted,
+    // щоб викликач знищив їх поза м'ютексом
+    Admit admit(std::unique_lock<std::mutex>& lock, OverloadPolicy policy, Priority priority, size_t bytes, bool may_wait,
+                std::vector<Job>& evicted) {
+        if (!closed && fits(1, bytes))
+            return Admit::Push;
+        if (closed) {
+            bump(counters.rejected);
+            return Admit::Reject;
+        }
+        switch (policy) {
+        case OverloadPolicy::DropOldest: {
+            QueuedJob entry;
+            while (!fits(1, bytes) && buffer.evict(priority, entry)) {
+                queued_bytes -= entry.job.footprint();
+                ++stats[static_cast<size_t>(entry.priority)].dropped;
+                bump(counters.dropped);
+                evicted.push_back(std::move(entry.job));
+            }
+            publish_depth();
+            if (fits(1, bytes))
+                return Admit::Push;
+            break;
+        }
+        case OverloadPolicy::CallerRuns:
+            if (!may_wait)
+                break;
+            bump(counters.caller_runs);
+            return Admit::RunHere;
+        case OverloadPolicy::Block: {
+            if (!may_wait)
+                break;
+            bump(counters.blocked);
+            ++space_waiters;
+            auto until = std::chrono::steady_clock::now() + limits.block_timeout;
+            bool room = space_cond.wait_until(lock, until, [&]() { return closed || fits(1, bytes); });
+            --space_waiters;
+            if (room && !closed)
+                return Admit::Push;
+            break;
+        }
+        case OverloadPolicy::RejectNewest:
+            break;
+        }
+        bump(counters.rejected);
+        return Admit::Reject;
+    }
+
+    // спільна частина schedule*() з межами буфера; push кладе job у буфер (під mtx)
+    template <typename Push>
+    bool enqueue(Job& job, Priority priority, bool may_wait, Push push) {
+        std::vector<Job> evicted; // знищуються після звільнення м'ютекса
+        Admit result;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            size_t bytes = job.footprint();
+            result = admit(lock, limits.policy, priority, bytes, may_wait, evicted);
+            if (result == Admit::Push) {
+                auto now = std::chrono::steady_clock::now();
+                bool was_empty = begin_push(now, priority);
+                push(now);
+                account(1, bytes);
+                end_push(was_empty);
+            }
+        }
+        if (result == Admit::RunHere) {
+            JobFailedScope scope;
+            job();
+            return true;
+        }
+        return result == Admit::Push;
+    }
+
+    // спільна частина schedule*(): облік надходження; повертає, чи був буфер порожнім
+    bool begin_push(std::chrono::steady_clock::time_point now, Priority priority, size_t count = 1) {
+        TRACE_EVENT(Enqueue, count);
+        bool was_empty = buffer.empty();
+        if (was_empty)
+            oldest_time = now;
+        stats[static_cast<size_t>(priority)].scheduled += count;
+        if (priority == Priority::High)
+            urgent_pending = true;
+        return was_empty;
+    }
+
+    // у подієвому режимі будить потік планувальника, коли з'являється перше завдання
+    // (щоб він почав відлік max_latency), коли досягнуто max_batch_size або надійшло завдання High
+    void end_push(bool was_empty) {
+        if (event_driven && (was_empty || urgent_pending || buffer.size() >= triggers.max_batch_size))
+            dispatch_cond.notify_one();
+    }
 };
 
 #endif // SCHEDULER_HPP
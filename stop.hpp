@@ -0,0 +1,58 @@
+#ifndef STOP_HPP
+#define STOP_HPP
+
+#include <atomic>
+#include <memory>
+
+// запит на кооперативне скасування (аналог std::stop_source / std::stop_token для C++17):
+// джерело встановлює прапорець, а завдання, що отримали токен, час від часу його перевіряють
+// і завершуються достроково; токен можна безпечно копіювати й перевіряти з будь-якого потоку
+class StopToken {
+public:
+    StopToken() = default;
+
+    bool stop_requested() const noexcept {
+        return state && state->load(std::memory_order_acquire);
+    }
+
+    // чи пов'язаний токен із джерелом (порожній токен ніколи не отримає запит)
+    bool stop_possible() const noexcept {
+        return static_cast<bool>(state);
+    }
+
+private:
+    friend class StopSource;
+
+    std::shared_ptr<const std::atomic<bool>> state;
+
+    explicit StopToken(std::shared_ptr<const std::atomic<bool>> state)
+        : state(std::move(state))
+    {
+    }
+};
+
+class StopSource {
+public:
+    StopSource()
+        : state(std::make_shared<std::atomic<bool>>(false))
+    {
+    }
+
+    StopToken get_token() const {
+        return StopToken(state);
+    }
+
+    // true, якщо запит зроблено саме цим викликом
+    bool request_stop() noexcept {
+        return !state->exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool stop_requested() const noexcept {
+        return state->load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state;
+};
+
+#endif // STOP_HPP
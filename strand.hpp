@@ -0,0 +1,229 @@
+#ifndef STRAND_HPP
+#define STRAND_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "cpu.hpp"
+#include "job.hpp"
+
+class ThreadPool;
+
+namespace strand_detail {
+
+// обслуговування черги пулом; визначено в threadpool.hpp (як post_continuation, див. future.hpp)
+// у статистиці пулу кожне завдання виконавця зараховується окремо (submitted — у admit(), виконання
+// і failed — у run()), а осушувач лише переносить їх і сам не рахується
+// admit() застосовує до завдання межі буфера пулу (AdmissionLimits): reserved — зайнятий обсяг,
+// який повертає release() (0 — пул без меж); false — завдання відхилено
+inline JobSlab* slab_of(ThreadPool* pool);
+inline bool admit(ThreadPool* pool, Job& job, size_t& reserved);
+inline void release(ThreadPool* pool, size_t reserved);
+inline void activate(ThreadPool* pool, Job drain);
+inline void run(ThreadPool* pool, Job& job);
+
+// стан послідовного виконавця: lock-free черга MPSC (Вьюков) з вузлів завдань і лічильник pending
+// відправник, що перевів pending з 0 в 1, ставить у пул одне завдання-"осушувач" (Drain), яке
+// виконує завдання черги по порядку; поки він працює, нові завдання лише додаються в чергу,
+// тож завдання одного виконавця ніколи не виконуються паралельно
+// вузли й великі захоплення беруть пам'ять зі slab-алокатора пулу, а завдання в черзі
+// займають місце в межах буфера пулу так само, як завдання в буфері планувальника
+class State : public std::enable_shared_from_this<State> {
+public:
+    // скільки завдань осушувач виконує за один запуск, перш ніж поступитися робітником
+    static constexpr unsigned BATCH = 64;
+
+    explicit State(ThreadPool* pool)
+        : pool(pool)
+        , slab(slab_of(pool))
+        , head(&stub)
+        , tail(&stub)
+    {
+    }
+
+    State(const State&) = delete;
+    State& operator=(const State&) = delete;
+
+    ~State() {
+        while (Node* node = pop())
+            free_node(node);
+    }
+
+    JobSlab* job_slab() const {
+        return slab;
+    }
+
+    // відхилене межами пулу завдання знищується без виконання
+    void post(Job job) {
+        size_t reserved = 0;
+        if (!admit(pool, job, reserved))
+            return;
+        job.set_submit_time(std::chrono::steady_clock::now());
+        Node* node = new (slab->allocate(sizeof(Node))) Node;
+        node->job = std::move(job);
+        node->reserved = reserved;
+        push(node);
+        if (pending.fetch_add(1, std::memory_order_acq_rel) == 0)
+            activate();
+    }
+
+    // виконання черги по порядку: не більше BATCH завдань, далі — новий запуск через пул
+    // (з робітника пулу він потрапляє в локальний дек того ж робітника, тож дані виконавця
+    // лишаються в його кеші, а інші робітники можуть перехопити його крадіжкою)
+    void drain() {
+        for (unsigned done = 0;; ++done) {
+            if (done == BATCH) {
+                activate();
+                return;
+            }
+            Node* node = wait_pop();
+            release(pool, std::exchange(node->reserved, 0));
+            // виняток одного завдання не зупиняє виконавця
+            run(pool, node->job);
+            free_node(node);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                return;
+        }
+    }
+
+    // осушувач знищено без запуску (пул відхилив або відкинув його під час зупинки):
+    // завдання черги знищуються так само, як відкинуті завдання пулу
+    void discard() {
+        while (true) {
+            free_node(wait_pop());
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                return;
+        }
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        Job job;
+        size_t reserved = 0; // місце в межах буфера пулу (див. admit())
+    };
+
+    // завдання пулу, що осушує чергу; знищене без запуску відкидає її (див. discard())
+    struct Drain {
+        std::shared_ptr<State> state;
+
+        explicit Drain(std::shared_ptr<State> state)
+            : state(std::move(state))
+        {
+        }
+
+        Drain(Drain&&) noexcept = default;
+
+        ~Drain() {
+            if (state)
+                state->discard();
+        }
+
+        void operator()() {
+            std::shared_ptr<State> self = std::move(state);
+            self->drain();
+        }
+    };
+
+    ThreadPool* pool;
+    JobSlab* slab;
+    Node stub;
+    alignas(CACHE_LINE_SIZE) std::atomic<Node*> head; // куди додають відправники
+    alignas(CACHE_LINE_SIZE) Node* tail; // звідки забирає осушувач (завжди один)
+    std::atomic<size_t> pending{0};
+
+    void activate() {
+        strand_detail::activate(pool, Job(Drain(shared_from_this())));
+    }
+
+    void free_node(Node* node) {
+        if (node->reserved)
+            release(pool, node->reserved);
+        node->~Node();
+        slab->deallocate(node, sizeof(Node));
+    }
+
+    void push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // nullptr — черга порожня або відправник ще не дописав зв'язок
+    Node* pop() {
+        Node* first = tail;
+        Node* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (!next)
+                return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(std::memory_order_acquire))
+            return nullptr;
+        push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+    // pending > 0 гарантує, що вузол уже доданий або от-от буде зв'язаний
+    Node* wait_pop() {
+        unsigned spins = 0;
+        Node* node;
+        while (!(node = pop()))
+            spin_backoff(spins++);
+        return node;
+    }
+};
+
+} // namespace strand_detail
+
+// Strand: послідовний виконавець поверх спільного пулу — завдання, передані через один Strand,
+// виконуються в порядку надходження і ніколи одночасно, без м'ютексів у коді користувача;
+// різні Strand виконуються паралельно на різних робітниках
+// поки черга виконавця непорожня, його завдання йдуть одне за одним на тому самому робітнику
+// копії Strand посилаються на ту саму чергу; завдання тримають стан живим, тож Strand можна
+// знищити, не чекаючи на них
+class Strand {
+public:
+    Strand() = default;
+
+    explicit Strand(ThreadPool& pool)
+        : state(std::make_shared<strand_detail::State>(&pool))
+    {
+    }
+
+    void execute(Job job) {
+        state->post(std::move(job));
+    }
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    void execute(F&& f) {
+        execute(Job(std::forward<F>(f), state->job_slab()));
+    }
+
+    explicit operator bool() const noexcept {
+        return static_cast<bool>(state);
+    }
+
+private:
+    std::shared_ptr<strand_detail::State> state;
+};
+
+inline Strand make_strand(ThreadPool& pool) {
+    return Strand(pool);
+}
+
+#endif // STRAND_HPP
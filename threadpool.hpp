@@ -1,113 +1,479 @@
 #ifndef THREADPOOL_HPP
 #define THREADPOOL_HPP
 
+#include <algorithm>
 #include <vector>
+#include <deque>
 #include <thread>
 #include <chrono>
 #include <iostream>
 #include <functional>
+#include <condition_variable>
 #include <mutex>
 #include <memory>
-#include <unordered_map>
+#include <type_traits>
+#include <tuple>
 #include "channel.hpp"
+#include "future.hpp"
+#include "histogram.hpp"
+#include "job.hpp"
+#include "metrics.hpp"
 #include "scheduler.hpp"
+#include "stop.hpp"
+#include "strand.hpp"
+#include "topology.hpp"
 #include "worker.hpp"
 
-using Job = std::function<void()>;
+// режим виконання: SharedQueue — усі робітники читають один спільний канал,
+// WorkStealing — кожен робітник має власний дек для завдань, створених усередині завдань,
+// і краде з деків інших, а спільний канал використовується лише для зовнішніх завдань
+enum class ExecutionMode {
+    SharedQueue,
+    WorkStealing
+};
+
+// режим роботи потоку планувальника: Batch — перенесення пакету раз на sleep_duration
+// з очікуванням завершення всього пакету, EventDriven — перенесення за тригерами
+// DispatchTriggers з асинхронним обліком завершених завдань
+enum class DispatchMode {
+    Batch,
+    EventDriven
+};
+
+// режим зупинки пулу: Drain — виконати все, що вже надійшло в пул, FinishRunning — дочекатися лише
+// завдань, що вже виконуються, відкинувши чергу (Future відкинутих завдань отримують broken_promise),
+// Abort — як FinishRunning, але ще й запит на скасування кооперативним завданням (get_stop_token())
+// в усіх режимах нові завдання після початку зупинки відкидаються, а таймери, що не настали, — скасовуються
+enum class ShutdownMode {
+    Drain,
+    FinishRunning,
+    Abort
+};
+
+// налаштування еластичного пулу: кількість робітників змінюється між min_workers і max_workers
+// новий робітник запускається, коли завдань у буфері та каналі більше ніж backlog_per_worker
+// на кожного робітника або коли канал безперервно непорожній довше за spawn_wait;
+// робітник, що простояв без роботи idle_timeout, отримує сигнал зупинки (порожнє завдання)
+struct ElasticOptions {
+    bool enabled = false;
+    size_t min_workers = 1;
+    size_t max_workers = 0; // 0 — max(size, std::thread::hardware_concurrency())
+    size_t backlog_per_worker = 16;
+    std::chrono::milliseconds spawn_wait{100};
+    std::chrono::milliseconds idle_timeout{5000};
+    std::chrono::milliseconds check_interval{50}; // період перевірки навантаження
+};
+
+// рішення еластичного пулу про зміну кількості робітників
+struct ScalingStats {
+    size_t workers = 0; // поточна кількість робітників
+    size_t peak_workers = 0;
+    size_t min_workers = 0;
+    size_t max_workers = 0;
+    uint64_t spawned_on_backlog = 0; // запуски через глибину черги
+    uint64_t spawned_on_wait = 0; // запуски через час очікування в каналі
+    uint64_t retired = 0; // зупинки через простій
+};
+
+// додаткові налаштування пулу
+struct ThreadPoolOptions {
+    ExecutionMode execution_mode = ExecutionMode::SharedQueue;
+    DispatchMode dispatch_mode = DispatchMode::Batch;
+    DispatchTriggers dispatch_triggers; // використовується лише в режимі EventDriven
+    // бекенд каналу завдань між планувальником і робітниками
+    ChannelBackend channel_backend = ChannelBackend::Mutex;
+    // місткість каналу завдань для бекенду LockFreeRing
+    size_t channel_capacity = DEFAULT_RING_CAPACITY;
+    ElasticOptions elastic;
+    // прив'язка робітників до процесорів; за Compact і Scatter кожен вузол NUMA отримує власний
+    // канал завдань, а робітник забирає завдання з каналів інших вузлів, лише коли його канал порожній
+    Placement placement = Placement::None;
+    // топологія для розміщення; вузли без процесорів відкидаються, а порожня (чи без жодного
+    // процесора) визначається через CpuTopology::detect()
+    CpuTopology topology;
+    // межі буфера планувальника й каналу та політика перевантаження (за замовчуванням без обмежень)
+    AdmissionLimits admission;
+};
 
 class ThreadPool {
 public:
 
     // ThreadPool: приймає кіл-ть робітників і час очікування -> передає у канал виконання
     ThreadPool(size_t size, std::chrono::seconds sleep_duration)
+        : ThreadPool(size, sleep_duration, ThreadPoolOptions())
+    {
+    }
+
+    ThreadPool(size_t size, std::chrono::seconds sleep_duration, const ThreadPoolOptions& options)
         : stop_flag(false)
         , sleep_duration(sleep_duration) // ініціалізація поля класу
     {
-        // створення каналів
-        channel = std::make_shared<Channel<Job>>(); // для передачі завдань від планувальника до робітників
-        backChannel = std::make_shared<Channel<std::pair<size_t, uint64_t>>>(); // для збору статистики від робітників
+        // порядок розміщення робітників: слот id займає процесор placement_order[id % size]
+        CpuTopology topology;
+        if (options.placement != Placement::None) {
+            topology = options.topology;
+            topology.drop_empty_nodes();
+            if (topology.empty())
+                topology = CpuTopology::detect();
+        }
+        placement_order = topology.order(options.placement);
 
-        // створення робітників
-        for (size_t id = 0; id < size; ++id) { // Worker, який отримує свій унікальний id
-            workers.emplace_back(new Worker(id, channel, backChannel)); // спільний канал завдань та канал для зворотного зв'язку
+        // створення каналів для передачі завдань від планувальника до робітників: по одному на вузол
+        // NUMA; канал створюється в потоці, прив'язаному до процесора свого вузла, тож пам'ять, яку
+        // він торкається першим (кільце бекенду LockFreeRing), виділяється на цьому вузлі
+        size_t nodes = std::max<size_t>(1, topology.nodes.size());
+        for (size_t node = 0; node < nodes; ++node) {
+            int cpu = topology.empty() ? -1 : topology.nodes[node].front();
+            std::shared_ptr<Channel<Job>> ch;
+            std::thread([&]() {
+                if (cpu >= 0)
+                    pin_current_thread(cpu);
+                ch = std::make_shared<Channel<Job>>(options.channel_backend, options.channel_capacity);
+                ch->set_limit(options.admission.max_channel_jobs);
+            }).join();
+            channels.push_back(ch);
+        }
+        channel = channels.front();
+        node_flush.resize(nodes);
+        // сигнал про завершення завдань: робітники рахують завершення у власних лічильниках,
+        // а потік планувальника чекає на нього, коли треба дочекатися кінця пакету
+        completions = std::make_shared<EventCount>();
+
+        // межі кількості робітників; у звичайному режимі обидві дорівнюють size
+        elastic = options.elastic;
+        if (elastic.enabled) {
+            if (elastic.max_workers == 0)
+                elastic.max_workers = std::max<size_t>(size, std::thread::hardware_concurrency());
+            elastic.min_workers = std::max<size_t>(1, std::min(elastic.min_workers, elastic.max_workers));
+            size = std::min(std::max(size, elastic.min_workers), elastic.max_workers);
+        } else {
+            elastic.min_workers = size;
+            elastic.max_workers = size;
+        }
+        // слоти робітників виділяються одразу на максимум, тож вектор не перевиділяється,
+        // поки інші потоки читають уже заповнені слоти
+        workers.resize(elastic.max_workers);
+
+        if (options.execution_mode == ExecutionMode::WorkStealing)
+            group = std::make_shared<WorkerGroup>(elastic.max_workers);
+        // у режимі SharedQueue з кількома вузлами робітники сплять на спільному сигналі всіх каналів,
+        // інакше запаркований робітник не помітив би завдань, надісланих в інший вузол
+        if (channels.size() > 1 && !group) {
+            wakeup = std::make_shared<EventCount>();
+            for (auto &ch : channels)
+                ch->set_wakeup(wakeup);
         }
 
         // створення планувальника
-        scheduler = std::make_shared<Scheduler>(channel);
+        bool event_driven = options.dispatch_mode == DispatchMode::EventDriven;
+        if (event_driven)
+            scheduler = std::make_shared<Scheduler>(channel, options.dispatch_triggers);
+        else
+            scheduler = std::make_shared<Scheduler>(channel);
+        // власний приймач потрібен для кількох вузлів, а також у режимі WorkStealing, де робітники
+        // паркуються не на каналі і самі не прокинуться, коли планувальник чекає на місце в кільці
+        if (channels.size() > 1 || group)
+            scheduler->set_sink([this](std::vector<Job>& jobs) { distribute(jobs); });
+        scheduler->set_admission(options.admission);
 
-        // нескінченний запускк циклу потоку планувальника 
-        scheduler_thread = std::thread([this]() {
-            // звертаємось до sleep_duration через this-указівник
-            std::this_thread::sleep_for(this->sleep_duration);
-
-            while (true) {
-                // час початку циклу для подальшого вимірювання часу виконання
-                auto start_time = std::chrono::steady_clock::now();
-
-                // переносить завдання з буфера в канал та повертає кіл-ть завдань, що були перенесені
-                uint64_t tasks = scheduler->run();
-
-                // збір інформації від робітників через зворотний канал
-                uint64_t done = 0;
-                while (done < tasks) {
-                    auto result = backChannel->receive();
-                    {
-                        std::lock_guard<std::mutex> lock(waiting_mtx);
-                        workers_waiting_times.push_back(result);
-                    }
-                    ++done;
-                }
+        // у пакетному режимі потік планувальника між пакетами чекає на завершення завдань,
+        // тож новий раніший таймер будить його через сигнал завершень
+        {
+            std::shared_ptr<EventCount> signal = completions;
+            scheduler->set_timer_wakeup([signal]() { signal->notify_all(); });
+        }
 
-                // обчислення часу для виконання поточного пакету завдань
-                auto elapsed = std::chrono::steady_clock::now() - start_time;
-                uint64_t execution_time = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
-                {
-                    std::lock_guard<std::mutex> lock(exec_mtx);
-                    queues_execution_times.push_back(execution_time);
-                }
+        // у подієвому режимі робітник без роботи будить планувальник
+        if (event_driven && options.dispatch_triggers.flush_on_idle) {
+            std::shared_ptr<Scheduler> sched = scheduler;
+            on_idle = [sched]() { sched->notify_idle(); };
+        }
 
-                std::cout << "Tasks were processing for " << execution_time << " seconds" << std::endl;
-
-                 // обчислення залишкового часу сну до наступного циклу (якщо час, що залишився, більше нуля, планувальник засинає)
-                auto elapsed_sec = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::steady_clock::now() - start_time
-                );
-                auto remaining_sleep = (this->sleep_duration > elapsed_sec)
-                    ? (this->sleep_duration - elapsed_sec)
-                    : std::chrono::seconds(0);
-
-                if (remaining_sleep.count() > 0) {
-                    std::cout << "Scheduler is sleeping for " << remaining_sleep.count() << " seconds" << std::endl;
-                    std::this_thread::sleep_for(remaining_sleep);
-                } else {
-                    // якщо вже не лишилось часу для сну — потік звільняється
-                    std::this_thread::yield();
-                }
+        // послідовні виконавці для execute(key, job); ключі розподіляються між ними за хешем
+        size_t strands = 64;
+        while (strands < elastic.max_workers * KEY_STRANDS_PER_WORKER)
+            strands *= 2;
+        for (size_t i = 0; i < strands; ++i)
+            key_strands.emplace_back(*this);
+
+        // створення робітників
+        for (size_t id = 0; id < size; ++id) {
+            spawn_worker();
+        }
+        scaling.peak_workers = size;
 
-                std::cout << "Scheduler is running" << std::endl;
+        if (elastic.enabled)
+            scaler_thread = std::thread([this]() { run_scaler(); });
 
-                // перевірка, чи треба зупиняти планувальник
-                {
-                    std::lock_guard<std::mutex> lock(stop_mtx);
-                    if (stop_flag) {
-                        std::cout << "Scheduler is stopping" << std::endl;
-                        break;
-                    }
-                }
-            }
+        // нескінченний запускк циклу потоку планувальника 
+        scheduler_thread = std::thread([this, event_driven]() {
+            if (event_driven)
+                run_event_loop();
+            else
+                run_batch_loop();
+            // shutdown() чекає на цей прапорець з дедлайном, а не приєднує потік наосліп
+            scheduler_done.store(true, std::memory_order_release);
+            completions->notify_all();
         });
     }
 
     // деструктор
+    // пул, який не зупинили явно, доробляє чергу; після join()/shutdown() нічого не робить
     ~ThreadPool() {
-        // join(); (щоб уникнути подвійного приєднання потоків)
+        shutdown(ShutdownMode::Drain);
     }
 
    // дозволяє додавати завдання до пулу, використовуючи метод планувальника
+    // у режимі WorkStealing завдання, створене всередині іншого завдання цього пулу,
+    // одразу потрапляє в локальний дек поточного робітника, оминаючи планувальник
+    // (крім пулу з межами AdmissionLimits, див. local_target())
     void execute(Job job) {
+        submitted.add();
+        if (Worker* self = local_target()) {
+            self->push_local(std::move(job));
+            return;
+        }
         scheduler->schedule(std::move(job));
     }
 
+    // try_execute(): як execute(), але не чекає на місце в буфері і не виконує завдання в потоці
+    // відправника: false — буфер повний (або пул зупиняється), завдання знищено без виконання
+    // з робітника в режимі WorkStealing без меж допуску завдання йде в локальний дек і завжди приймається
+    bool try_execute(Job job, Priority priority = Priority::Normal) {
+        submitted.add();
+        if (Worker* self = local_target()) {
+            self->push_local(std::move(job));
+            return true;
+        }
+        return scheduler->try_schedule(std::move(job), priority);
+    }
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    bool try_execute(F&& f, Priority priority = Priority::Normal) {
+        return try_execute(Job(std::forward<F>(f), &slab), priority);
+    }
+
+    // перевантаження для довільного callable: Job будується одразу тут, тож захоплення,
+    // що не вміщуються у вбудований буфер, беруть пам'ять із slab-алокатора цього пулу
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    void execute(F&& f) {
+        execute(Job(std::forward<F>(f), &slab));
+    }
+
+    // execute(key, job): завдання з однаковим ключем виконуються в порядку надходження і ніколи
+    // одночасно (через Strand, закріплений за ключем), тож стан ключа (сесія, шард) не потребує
+    // м'ютекса; завдання різних ключів розходяться між робітниками, а поспіль надіслані завдання
+    // одного ключа виконуються на тому самому робітнику
+    // різні ключі можуть потрапити в один Strand (їх кількість фіксована) і тоді також виконуються
+    // послідовно; для повністю незалежної черги є make_strand(pool)
+    template <typename Key, typename F,
+              typename = std::enable_if_t<!std::is_invocable<Key&>::value &&
+                                          std::is_invocable<std::decay_t<F>&>::value>>
+    void execute(const Key& key, F&& f) {
+        uint64_t h = static_cast<uint64_t>(std::hash<Key>()(key)) * 0x9E3779B97F4A7C15ull;
+        key_strands[(h >> 32) & (key_strands.size() - 1)].execute(make_job(std::forward<F>(f)));
+    }
+
+    // execute() з класом пріоритету або явним дедлайном: такі завдання завжди йдуть через
+    // буфер планувальника, де впорядковуються за найближчим дедлайном (див. JobQueue)
+    void execute(Job job, Priority priority) {
+        submitted.add();
+        scheduler->schedule(std::move(job), priority);
+    }
+
+    void execute(Job job, std::chrono::steady_clock::time_point deadline, Priority priority = Priority::Normal) {
+        submitted.add();
+        scheduler->schedule(std::move(job), deadline, priority);
+    }
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    void execute(F&& f, Priority priority) {
+        execute(Job(std::forward<F>(f), &slab), priority);
+    }
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    void execute(F&& f, std::chrono::steady_clock::time_point deadline, Priority priority = Priority::Normal) {
+        execute(Job(std::forward<F>(f), &slab), deadline, priority);
+    }
+
+    // execute_at() / execute_after(): завдання потрапить у пул не раніше заданого часу
+    // execute_every(): завдання виконується кожен period (перший раз — через period після виклику);
+    // наступний запуск планується після завершення попереднього, тож запуски не перекриваються
+    // таймери лежать в ієрархічному колесі планувальника і спрацьовують у потоці планувальника,
+    // тож очікування не займає жодного потоку; повернутий дескриптор передається в cancel()
+    // на паузі таймери не спрацьовують; таймери, що не спрацювали до join(), відкидаються
+    // у submitted таймер зараховується під час кожного спрацювання, а не під час реєстрації
+    TimerHandle execute_at(std::chrono::steady_clock::time_point when, Job job) {
+        return scheduler->schedule_at(when, std::move(job));
+    }
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    TimerHandle execute_at(std::chrono::steady_clock::time_point when, F&& f) {
+        return execute_at(when, Job(std::forward<F>(f), &slab));
+    }
+
+    template <typename Rep, typename Period, typename F>
+    TimerHandle execute_after(std::chrono::duration<Rep, Period> delay, F&& f) {
+        return execute_at(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay), std::forward<F>(f));
+    }
+
+    template <typename Rep, typename Period, typename F>
+    TimerHandle execute_every(std::chrono::duration<Rep, Period> period, F&& f) {
+        auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        return scheduler->schedule_at(std::chrono::steady_clock::now() + step, make_job(std::forward<F>(f)), step);
+    }
+
+    // скасування таймера execute_at/after/every; false, якщо одноразовий таймер уже спрацював
+    // (для періодичного запуск, що вже йде, завершиться, але наступних не буде)
+    bool cancel(TimerHandle handle) {
+        return scheduler->cancel_timer(handle);
+    }
+
+    // кількість таймерів, що очікують спрацювання
+    size_t timer_count() const {
+        return scheduler->timer_count();
+    }
+
+    // spawn(): запуск корутини coro::Task (див. coro.hpp, потрібен C++20) на робітниках пулу
+    // повертає Future з результатом корутини або її винятком
+    template <typename Task>
+    auto spawn(Task task) -> Future<typename Task::value_type> {
+        using R = typename Task::value_type;
+        auto* state = future_detail::State<R>::create(this, &slab);
+        state->add_ref();
+        std::move(task).start(*this, future_detail::Promise<R>(state));
+        return Future<R>(state);
+    }
+
+    // лічильники класу пріоритету: кількість завдань і час, проведений у буфері планувальника
+    PriorityStats priority_stats(Priority priority) {
+        return scheduler->priority_stats(priority);
+    }
+
+    // execute_bulk(): додає до пулу цілий діапазон завдань (Job або довільних callable)
+    // одним захопленням м'ютекса планувальника; з rvalue-діапазону елементи переміщуються,
+    // з lvalue — копіюються, тому діапазон Job (move-only) передається лише як rvalue
+    template <typename Range>
+    void execute_bulk(Range&& range) {
+        std::vector<Job> jobs;
+        for (auto &item : range) {
+            if constexpr (std::is_lvalue_reference<Range>::value) {
+                static_assert(!std::is_same<std::decay_t<decltype(item)>, Job>::value,
+                              "execute_bulk: Job is move-only, pass the range as an rvalue (std::move)");
+                jobs.push_back(make_job(item));
+            } else {
+                jobs.push_back(make_job(std::move(item)));
+            }
+        }
+        submitted.add(jobs.size());
+
+        if (Worker* self = local_target()) {
+            for (auto &job : jobs)
+                self->push_local(std::move(job));
+            return;
+        }
+        scheduler->schedule_batch(jobs);
+    }
+
+    // кількість вузлів NUMA, кожен з яких має власний канал завдань (1 без політики розміщення)
+    size_t node_count() const {
+        return channels.size();
+    }
+
+    // кількість робітників пулу (в еластичному режимі — поточна)
+    size_t size() const {
+        return live.load(std::memory_order_acquire);
+    }
+
+    // лічильники допуску завдань і глибина черг (буфер планувальника та канали)
+    // для раннього скидання навантаження балансувальником перед пулом
+    AdmissionStats admission_stats() {
+        AdmissionStats result = scheduler->admission_stats();
+        result.channel_jobs = queue_size();
+        return result;
+    }
+
+    // знімок показників працюючого пулу без блокувань: лічильники робітників (у власних кеш-лініях),
+    // глибина буфера й каналів, перенесення планувальника; сумарні значення збираються під час читання
+    MetricsSnapshot snapshot() const {
+        MetricsSnapshot snap;
+        snap.submitted = submitted.load() + scheduler->timers_fired();
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i) {
+            const Worker& worker = *workers[i];
+            const WorkerStats& st = worker.get_stats();
+            WorkerMetrics w;
+            w.id = worker.get_id();
+            w.node = worker.get_node();
+            w.running = worker.is_running();
+            w.executed = st.execution.samples();
+            w.failed = st.failed.load(std::memory_order_relaxed);
+            w.steals = st.steals.load(std::memory_order_relaxed);
+            w.parks = st.parks.load(std::memory_order_relaxed);
+            w.busy_ns = st.execution.total();
+            w.idle_ns = st.idle_wait.total();
+            snap.executed += w.executed;
+            snap.failed += w.failed;
+            snap.steals += w.steals;
+            snap.parks += w.parks;
+            snap.per_worker.push_back(w);
+        }
+        AdmissionStats adm = scheduler->admission_stats();
+        snap.accepted = adm.accepted;
+        snap.rejected = adm.rejected;
+        snap.dropped = adm.dropped;
+        snap.caller_runs = adm.caller_runs;
+        snap.workers = size();
+        snap.buffer_jobs = adm.queued_jobs;
+        snap.buffer_bytes = adm.queued_bytes;
+        for (auto &ch : channels)
+            snap.channel_jobs += ch->len();
+        snap.timers = scheduler->timer_count();
+        snap.flush_size = scheduler->flush_sizes().snapshot();
+        snap.flush_time = scheduler->flush_times().snapshot();
+        snap.queue_wait = merge_workers(&WorkerStats::queue_wait);
+        snap.execution = merge_workers(&WorkerStats::execution);
+        return snap;
+    }
+
+    // запуск фонового експорту показників у форматі Prometheus (файл або локальний сокет);
+    // повторний виклик замінює попередній експортер; false — не вдалося відкрити сокет
+    bool export_metrics(const ExporterOptions& options) {
+        exporter.reset();
+        exporter.reset(new MetricsExporter([this]() { return snapshot(); }, options));
+        return exporter->is_open();
+    }
+
+    // лічильники рішень еластичного пулу
+    ScalingStats scaling_stats() {
+        std::lock_guard<std::mutex> lock(scaling_mtx);
+        ScalingStats result = scaling;
+        result.workers = size();
+        result.min_workers = elastic.min_workers;
+        result.max_workers = elastic.max_workers;
+        return result;
+    }
+
+    // submit(): як execute(), але повертає Future з результатом f(args...) або його винятком
+    // стан Future виділяється з slab пулу і не містить м'ютексів, а завдання разом зі
+    // захопленнями зазвичай вміщується у вбудований буфер Job
+    template <typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> Future<std::invoke_result_t<std::decay_t<F>&, std::decay_t<Args>&...>> {
+        using R = std::invoke_result_t<std::decay_t<F>&, std::decay_t<Args>&...>;
+        auto* state = future_detail::State<R>::create(this, &slab);
+        state->add_ref();
+        execute([promise = future_detail::Promise<R>(state),
+                 fn = std::forward<F>(f),
+                 bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            promise.run([&]() -> R { return std::apply(fn, bound); });
+        });
+        return Future<R>(state);
+    }
+
     // методи для призупинення та відновлення роботи планувальника
     void pause() {
         scheduler->pause();
@@ -118,50 +484,88 @@ public:
     }
 
     // метод stop() встановлює прапорець stop_flag та сигналізує про завершення робботи
+    // перериває будь-яке очікування потоку планувальника (сон між пакетами, очікування завершень)
     void stop() {
-        std::lock_guard<std::mutex> lock(stop_mtx);
-        stop_flag = true;
+        {
+            std::lock_guard<std::mutex> lock(stop_mtx);
+            stop_flag = true;
+        }
+        stop_cond.notify_all();
+        scheduler->interrupt();
+        completions->notify_all();
     }
 
-    // метод join(): викликає stop() -> приєднує потік планувальника -> надсилає сигнал зупинки робітникам -> приєднує потоки співробітників
-    void join() {
-        stop();
-        if (scheduler_thread.joinable()) {
+    // shutdown(): зупинка пулу в заданому режимі з дедлайном; повертає true, коли всі потоки
+    // приєднано; якщо дедлайн настав раніше, режим посилюється до Abort (черга відкидається,
+    // кооперативні завдання отримують запит на скасування) і повертається false — потоки, що
+    // ще виконують завдання, приєднає наступний виклик shutdown()/join() або деструктор
+    // повторний виклик може лише посилити режим
+    bool shutdown(ShutdownMode mode,
+                  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) {
+        std::lock_guard<std::mutex> guard(shutdown_mtx);
+        request_shutdown(mode);
+
+        // потік планувальника виходить зі свого циклу й переносить у канал останні завдання
+        if (!wait_until_done([this]() { return scheduler_done.load(std::memory_order_acquire); }, deadline))
+            return escalate();
+        if (scheduler_thread.joinable())
             scheduler_thread.join();
-        }
+        if (scaler_thread.joinable())
+            scaler_thread.join();
 
-        // надсилання сигналу зупинки всім робітникам 
-        for (size_t i = 0; i < workers.size(); ++i) {
-            channel->send(Job());
-        }
+        // останнє перенесення могло покласти в канал завдання, які цей режим не виконує
+        if (shutdown_level() >= ShutdownMode::FinishRunning)
+            discard_queued();
+        send_stop_signals();
 
+        if (!wait_until_done([this]() { return running_workers() == 0; }, deadline))
+            return escalate();
         // приєднуєлнання до всіх робітників
-        for (auto &worker : workers) {
-            worker->join();
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i) {
+            workers[i]->join();
         }
+        return true;
+    }
 
+    template <typename Rep, typename Period>
+    bool shutdown(ShutdownMode mode, std::chrono::duration<Rep, Period> timeout) {
+        return shutdown(mode, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+    // метод join(): виконує всі завдання, що надійшли до виклику, приєднує всі потоки й виводить статистику
+    void join() {
+        shutdown(ShutdownMode::Drain);
         print_stats();
     }
 
-    // метод detach() від'єднує потік планувальника та робітників, а потім виводить статистику
+    // метод detach(): починає зупинку з виконанням черги і повертається, не чекаючи на потоки;
+    // потоки приєднає деструктор (або join()/shutdown()), тож вони не переживуть каналів пулу
     void detach() {
-        stop();
-        if (scheduler_thread.joinable()) {
-            scheduler_thread.detach();
-        }
-        for (auto &worker : workers) {
-            worker->detach();
-        }
+        request_shutdown(ShutdownMode::Drain);
         print_stats();
     }
 
+    // токен скасування для кооперативних завдань: запит надходить під час shutdown(ShutdownMode::Abort)
+    // (або коли дедлайн іншого режиму минув); довгі завдання перевіряють його й завершуються достроково
+    StopToken get_stop_token() const {
+        return cancel_source.get_token();
+    }
+
+    bool stop_requested() {
+        std::lock_guard<std::mutex> lock(stop_mtx);
+        return stop_flag;
+    }
+
     // додаткові гетери для перевірки стану каналів і буфера
     bool is_empty() {
-        return channel->is_empty();
+        return queue_size() == 0;
     }
 
     size_t queue_size() {
-        return channel->len();
+        size_t total = 0;
+        for (auto &ch : channels)
+            total += ch->len();
+        return total;
     }
 
     bool is_buffer_empty() {
@@ -172,56 +576,615 @@ public:
         return scheduler->size();
     }
 
+    // зведені затримки всіх робітників (у наносекундах); гістограми зливаються під час виклику
+    struct LatencyStats {
+        LatencySnapshot idle_wait; // очікування робітником нового завдання
+        LatencySnapshot queue_wait; // від надходження в пул до початку виконання
+        LatencySnapshot execution; // виконання завдання
+        LatencySnapshot end_to_end; // від надходження в пул до завершення
+        LatencySnapshot batch; // виконання пакету, перенесеного планувальником
+    };
+
+    LatencyStats latency_stats() const {
+        LatencyStats result;
+        result.idle_wait = merge_workers(&WorkerStats::idle_wait);
+        result.queue_wait = merge_workers(&WorkerStats::queue_wait);
+        result.execution = merge_workers(&WorkerStats::execution);
+        result.end_to_end = merge_workers(&WorkerStats::end_to_end);
+        result.batch = batch_times.snapshot();
+        return result;
+    }
+
 private:
-    std::vector<std::unique_ptr<Worker>> workers; // контейнер для зберігання робітників
-    std::shared_ptr<Channel<Job>> channel; // канал для передачі завдань до робітників
-    std::shared_ptr<Channel<std::pair<size_t, uint64_t>>> backChannel; // канал для отримання статистики від робітників
+    JobSlab slab; // пам'ять для великих захоплень і вузлів деків; оголошено першим, щоб пережити всі Job пулу
+    // слоти робітників (розміром max_workers); заповнюються по порядку і не звільняються до
+    // знищення пулу: зупинений через простій робітник перезапускається у своєму слоті,
+    // тож його дек і статистика лишаються дійсними для інших потоків
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> spawned{0}; // скільки слотів уже містять робітника
+    std::atomic<size_t> live{0}; // робітники, яким не надіслано сигнал зупинки
+    std::function<void()> on_idle; // передається кожному новому робітнику
+    std::shared_ptr<Channel<Job>> channel; // канал для передачі завдань до робітників (канал вузла 0)
+    std::vector<std::shared_ptr<Channel<Job>>> channels; // канали вузлів NUMA
+    std::vector<std::pair<int, size_t>> placement_order; // (процесор, вузол) для слотів робітників
+    std::vector<std::vector<Job>> node_flush; // завдання поточного перенесення за вузлами
+    size_t distribute_cursor = 0; // наступний робітник у черзі distribute(); лише потік планувальника
+    std::shared_ptr<EventCount> wakeup; // спільний сигнал каналів вузлів (див. WorkerPlacement)
+    std::shared_ptr<EventCount> completions; // сигнал робітників про завершення завдань з каналу
     std::shared_ptr<Scheduler> scheduler; // планувальник, який управляє буфером завдань
+    std::shared_ptr<WorkerGroup> group; // спільний стан робітників у режимі WorkStealing (nullptr у режимі SharedQueue)
 
     std::thread scheduler_thread; // потік, у якому працює планувальник
     bool stop_flag; // прапорець для сигналу зупинки роботи планувальника
     std::mutex stop_mtx; // м'ютекс для синхронізації доступу до stop_flag
+    std::condition_variable stop_cond; // перериває очікування потоку масштабування
+    int shutdown_mode = -1; // найсильніший запитаний ShutdownMode (-1 — зупинку не запитано); під stop_mtx
+    StopSource cancel_source; // запит на скасування кооперативних завдань (режим Abort)
+    std::atomic<bool> scheduler_done{false}; // потік планувальника завершив останнє перенесення
+    std::mutex shutdown_mtx; // послідовність кроків shutdown() з різних потоків
+    bool stops_sent = false; // сигнали зупинки робітникам уже надіслано; під shutdown_mtx
+
+    // стан еластичного режиму; змінює лише потік масштабування
+    ElasticOptions elastic;
+    std::thread scaler_thread;
+    ScalingStats scaling;
+    std::mutex scaling_mtx; // м'ютекс для читання scaling з інших потоків
+    bool backlogged = false; // у каналі при останній перевірці лежали завдання
+    std::chrono::steady_clock::time_point backlog_since; // з якого моменту канал безперервно непорожній
 
     // поле для інтервалу очікування 
     std::chrono::seconds sleep_duration;
 
-    // Дані для збору статистики
-    std::vector<std::pair<size_t, uint64_t>> workers_waiting_times; // зберігає для кожного робітника час очікування завдання
-    std::vector<uint64_t> queues_execution_times; // зберігає час виконання кожного "пакету" завдань
-    std::mutex waiting_mtx; // м'ютекс для синхронізації доступу до статистики часу очікування
-    std::mutex exec_mtx; // м'ютекс для синхронізації доступу до статистики часу виконання
+    // Дані для збору статистики (стала пам'ять незалежно від кількості завдань)
+    LatencyHistogram batch_times; // час виконання кожного "пакету" завдань; пише лише потік планувальника
+    uint64_t dispatched = 0; // скільки завдань планувальник переніс у канал за весь час
+    uint64_t collected = 0; // скільки з них уже зараховано в pending_batches
 
-    void print_stats() {
-        std::lock_guard<std::mutex> lock(waiting_mtx);
-        std::cout << "Worker waiting times:" << std::endl;
-        // групування часу очікування за ідентифікатором робітника
-        std::unordered_map<size_t, std::vector<uint64_t>> total_waiting_time;
+    // пакети, перенесені в подієвому режимі, завершення яких ще очікується: (час перенесення, залишок завдань)
+    // завершення зараховуються найстарішому пакету, бо робітники беруть завдання з каналу в порядку FIFO
+    std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>> pending_batches;
+
+    // послідовні виконавці для execute(key, job); кількість — степінь двійки
+    static constexpr size_t KEY_STRANDS_PER_WORKER = 8;
+    std::vector<Strand> key_strands;
 
-        // обчислення середнього часу очікування для кожного робітника
-        for (const auto &entry : workers_waiting_times) {
-            total_waiting_time[entry.first].push_back(entry.second);
+    StripedCounter submitted; // завдання, передані в пул з будь-яких потоків
+    // оголошено останнім: знищується першим, поки решта пулу, з якої він читає знімки, ще жива
+    std::unique_ptr<MetricsExporter> exporter;
+
+    // цикл пакетного режиму: перенесення буфера раз на sleep_duration і очікування завершення пакету;
+    // сон і очікування перериваються через stop()
+    void run_batch_loop() {
+        // звертаємось до sleep_duration через this-указівник
+        sleep_until(std::chrono::steady_clock::now() + this->sleep_duration);
+
+        while (true) {
+            // час початку циклу для подальшого вимірювання часу виконання
+            auto start_time = std::chrono::steady_clock::now();
+
+            // переносить завдання з буфера в канал та повертає кіл-ть завдань, що були перенесені
+            uint64_t tasks = scheduler->run();
+            wake_workers(tasks);
+
+            // очікування, поки робітники завершать усі перенесені завдання
+            // (разом із завданнями таймерів, що спрацюють за цей час)
+            dispatched += tasks;
+            wait_for_completions();
+
+            // обчислення часу для виконання поточного пакету завдань
+            auto elapsed = std::chrono::steady_clock::now() - start_time;
+            batch_times.record(elapsed);
+
+            std::cout << "Tasks were processing for " << std::chrono::duration<double>(elapsed).count() << " seconds" << std::endl;
+
+             // обчислення залишкового часу сну до наступного циклу (якщо час, що залишився, більше нуля, планувальник засинає)
+            auto elapsed_sec = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - start_time
+            );
+            auto remaining_sleep = (this->sleep_duration > elapsed_sec)
+                ? (this->sleep_duration - elapsed_sec)
+                : std::chrono::seconds(0);
+
+            if (remaining_sleep.count() > 0 && !stop_requested()) {
+                std::cout << "Scheduler is sleeping for " << remaining_sleep.count() << " seconds" << std::endl;
+                sleep_until(std::chrono::steady_clock::now() + remaining_sleep);
+            } else {
+                // якщо вже не лишилось часу для сну — потік звільняється
+                std::this_thread::yield();
+            }
+
+            // перевірка, чи треба зупиняти планувальник
+            if (stop_requested())
+                break;
+            std::cout << "Scheduler is running" << std::endl;
+        }
+
+        // завдання, що встигли потрапити в буфер до зупинки, передаються робітникам (без очікування)
+        std::cout << "Scheduler is stopping" << std::endl;
+        scheduler->close();
+        wake_workers(scheduler->run());
+    }
+
+    // цикл подієвого режиму: перенесення за тригерами планувальника без очікування завершення пакету,
+    // тож нові завдання можуть потрапити в канал, поки попередній пакет ще виконується
+    void run_event_loop() {
+        while (scheduler->wait_for_dispatch()) {
+            dispatch();
+            collect_completions();
+        }
+        // завдання, що встигли потрапити в буфер до зупинки, також передаються робітникам
+        scheduler->close();
+        dispatch();
+        std::cout << "Scheduler is stopping" << std::endl;
+    }
+
+    void dispatch() {
+        auto now = std::chrono::steady_clock::now();
+        uint64_t tasks = scheduler->run();
+        wake_workers(tasks);
+        if (tasks > 0)
+            pending_batches.emplace_back(now, tasks);
+    }
+
+    // неблокувальний облік завершень: різниця лічильників робітників з минулого виклику
+    // розподіляється між пакетами, що ще виконуються
+    void collect_completions() {
+        uint64_t done = completed_jobs();
+        uint64_t fresh = done - collected;
+        collected = done;
+        while (fresh > 0 && !pending_batches.empty()) {
+            uint64_t take = std::min(fresh, pending_batches.front().second);
+            fresh -= take;
+            if ((pending_batches.front().second -= take) > 0)
+                break;
+
+            auto elapsed = std::chrono::steady_clock::now() - pending_batches.front().first;
+            pending_batches.pop_front();
+            batch_times.record(elapsed);
+        }
+    }
+
+    // сон потоку планувальника в пакетному режимі: таймери, що настають тим часом, спрацьовують вчасно
+    void sleep_until(std::chrono::steady_clock::time_point until) {
+        while (scheduler->wait_for_timers(until))
+            fire_timers();
+    }
+
+    void fire_timers() {
+        uint64_t fired = scheduler->run_timers();
+        wake_workers(fired);
+        dispatched += fired;
+    }
+
+    // сумарна кількість завершених завдань з каналу за лічильниками всіх робітників
+    uint64_t completed_jobs() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i)
+            total += workers[i]->get_stats().completed.load(std::memory_order_acquire);
+        return total;
+    }
+
+    // запуск ще одного робітника: спершу перезапускається зупинений, інакше займається новий слот
+    // викликається з конструктора і далі лише з потоку масштабування
+    void spawn_worker() {
+        size_t count = spawned.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            if (!workers[i]->is_running()) {
+                workers[i]->restart();
+                live.fetch_add(1, std::memory_order_release);
+                return;
+            }
+        }
+        WorkerPlacement place;
+        std::tie(place.cpu, place.node) = placement_order[count % placement_order.size()];
+        for (size_t node = 0; node < channels.size(); ++node)
+            if (node != place.node)
+                place.remote.push_back(channels[node]);
+        place.wakeup = wakeup;
+        // канал вузла робітника, сигнал завершень, розміщення та slab для вузлів локального деку
+        workers[count].reset(new Worker(count, channels[place.node], completions, group, on_idle, std::move(place), &slab));
+        spawned.store(count + 1, std::memory_order_release);
+        live.fetch_add(1, std::memory_order_release);
+    }
+
+    // цикл потоку масштабування: перевірка навантаження кожні check_interval до stop()
+    void run_scaler() {
+        std::unique_lock<std::mutex> lock(stop_mtx);
+        while (!stop_cond.wait_for(lock, elastic.check_interval, [this]() { return stop_flag; })) {
+            lock.unlock();
+            scale();
+            lock.lock();
+        }
+    }
+
+    // одне рішення за перевірку: запуск робітника під навантаженням або зупинка одного
+    // робітника після простою; сигнал зупинки — одне порожнє завдання в каналі, яке забирає
+    // рівно один робітник (за порожнього каналу — один із бездіяльних)
+    void scale() {
+        auto now = std::chrono::steady_clock::now();
+        size_t waiting = queue_size();
+        size_t backlog = scheduler->size() + waiting;
+        size_t current = size();
+
+        if (waiting == 0) {
+            backlogged = false;
+        } else if (!backlogged) {
+            backlogged = true;
+            backlog_since = now;
+        }
+
+        if (current < elastic.max_workers) {
+            bool on_backlog = backlog > elastic.backlog_per_worker * current;
+            bool on_wait = backlogged && now - backlog_since >= elastic.spawn_wait;
+            if (on_backlog || on_wait) {
+                spawn_worker();
+                backlog_since = now;
+                {
+                    std::lock_guard<std::mutex> lock(scaling_mtx);
+                    if (on_backlog)
+                        ++scaling.spawned_on_backlog;
+                    else
+                        ++scaling.spawned_on_wait;
+                    scaling.peak_workers = std::max(scaling.peak_workers, current + 1);
+                }
+                std::cout << "Scaling up to " << current + 1 << " workers (backlog " << backlog << ")" << std::endl;
+                return;
+            }
+        }
+
+        if (current <= elastic.min_workers || backlog > 0 || retiring() > 0)
+            return;
+        auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(elastic.idle_timeout).count();
+        auto now_rep = now.time_since_epoch().count();
+        for (size_t i = 0; i < spawned.load(std::memory_order_relaxed); ++i) {
+            auto since = workers[i]->idle_since();
+            if (!workers[i]->is_running() || since == 0 || now_rep - since < timeout)
+                continue;
+            live.fetch_sub(1, std::memory_order_release);
+            channels[workers[i]->get_node()]->send(Job());
+            wake_workers(1);
+            {
+                std::lock_guard<std::mutex> lock(scaling_mtx);
+                ++scaling.retired;
+            }
+            std::cout << "Scaling down to " << current - 1 << " workers (idle timeout)" << std::endl;
+            return;
+        }
+    }
+
+    // приймач планувальника за кількох вузлів: завдання (у порядку дедлайнів) роздаються по черзі
+    // працюючим робітникам, тож кожен вузол отримує частку, пропорційну кількості своїх робітників,
+    // і найтерміновіші завдання не скупчуються в одному каналі
+    // черга продовжується з наступного перенесення (distribute_cursor), тож і перенесення
+    // по одному завданню розходяться по всіх вузлах
+    void distribute(std::vector<Job>& jobs) {
+        std::vector<size_t> targets;
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i)
+            if (workers[i]->is_running())
+                targets.push_back(workers[i]->get_node());
+        if (targets.empty())
+            targets.push_back(0);
+        for (auto &job : jobs)
+            node_flush[targets[distribute_cursor++ % targets.size()]].push_back(std::move(job));
+        for (size_t node = 0; node < channels.size(); ++node) {
+            auto &part = node_flush[node];
+            if (part.empty())
+                continue;
+            send_part(*channels[node], part);
+            part.clear();
+        }
+    }
+
+    // пакетна відправка в канал вузла; у режимі WorkStealing з обмеженим каналом перед блокуванням
+    // на повному каналі будимо всіх робітників, щоб вони звільнили місце
+    void send_part(Channel<Job>& ch, std::vector<Job>& part) {
+        if (!group || !ch.is_bounded()) {
+            ch.send_bulk(std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+            return;
+        }
+        for (auto &job : part) {
+            if (ch.try_send(std::move(job)))
+                continue;
+            wake_workers(size());
+            ch.send(std::move(job));
+        }
+    }
+
+    // робітник цього пулу, з якого надсилається завдання, якщо воно може піти в його локальний дек;
+    // за заданих меж AdmissionLimits завдання з робітників теж проходять через буфер планувальника,
+    // щоб займати місце в тих самих межах і потрапляти в AdmissionStats
+    Worker* local_target() const {
+        if (scheduler->has_limits())
+            return nullptr;
+        Worker* self = Worker::current();
+        return self && self->belongs_to(group.get()) ? self : nullptr;
+    }
+
+    // чи читає робітник один із каналів цього пулу
+    bool owns(const Worker* worker) const {
+        for (auto &ch : channels)
+            if (worker->serves(ch.get()))
+                return true;
+        return false;
+    }
+
+    // скільки робітників отримали сигнал зупинки через простій, але ще не зупинилися
+    // live і прапорці робітників змінюються окремо, тож на мить running може бути меншим за size()
+    size_t retiring() const {
+        size_t running = 0;
+        for (size_t i = 0; i < spawned.load(std::memory_order_relaxed); ++i)
+            running += workers[i]->is_running();
+        size_t current = size();
+        return running > current ? running - current : 0;
+    }
+
+    // блокування потоку планувальника, доки робітники не завершать усі перенесені завдання;
+    // тим часом планувальник прокидається до таймерів (next_timer() після prepare_wait(),
+    // тож раніший таймер, доданий під час засинання, розбудить його через timer_wakeup)
+    // stop() перериває очікування: решту пакету робітники доробляють уже без планувальника
+    void wait_for_completions() {
+        while (completed_jobs() < dispatched) {
+            uint64_t ticket = completions->prepare_wait();
+            if (completed_jobs() >= dispatched || stop_requested()) {
+                completions->cancel_wait();
+                break;
+            }
+            auto next = scheduler->next_timer();
+            if (next <= std::chrono::steady_clock::now()) {
+                completions->cancel_wait();
+                fire_timers();
+                continue;
+            }
+            if (next == std::chrono::steady_clock::time_point::max())
+                completions->wait(ticket);
+            else
+                completions->wait_until(ticket, next);
         }
+    }
 
-        for (const auto &entry : total_waiting_time) {
-            uint64_t sum = 0;
-            for (auto t : entry.second) {
-                sum += t;
+    ShutdownMode shutdown_level() {
+        std::lock_guard<std::mutex> lock(stop_mtx);
+        return static_cast<ShutdownMode>(shutdown_mode);
+    }
+
+    // запуск зупинки без очікування; режим лише посилюється (Drain -> FinishRunning -> Abort)
+    void request_shutdown(ShutdownMode mode) {
+        {
+            std::lock_guard<std::mutex> lock(stop_mtx);
+            if (shutdown_mode >= static_cast<int>(mode))
+                return;
+            shutdown_mode = static_cast<int>(mode);
+        }
+        // планувальник закривається тут же, а черга відкидається до stop(): інакше завдання, надіслані
+        // до закриття в потоці планувальника, або сам буфер потрапили б у канал, і робітники почали б
+        // виконувати відкинуті завдання
+        if (mode >= ShutdownMode::FinishRunning) {
+            scheduler->close();
+            discard_queued();
+        }
+        stop();
+        if (mode == ShutdownMode::Abort)
+            cancel_source.request_stop();
+    }
+
+    // дедлайн shutdown() минув: далі лише скасування, потоки лишаються неприєднаними
+    bool escalate() {
+        request_shutdown(ShutdownMode::Abort);
+        std::cout << "Shutdown deadline exceeded, aborting" << std::endl;
+        return false;
+    }
+
+    // очікування умови, яку змінюють робітники або потік планувальника (обидва сигналять через completions)
+    template <typename Pred>
+    bool wait_until_done(Pred done, std::chrono::steady_clock::time_point deadline) {
+        while (!done()) {
+            uint64_t ticket = completions->prepare_wait();
+            if (done()) {
+                completions->cancel_wait();
+                break;
+            }
+            if (deadline == std::chrono::steady_clock::time_point::max()) {
+                completions->wait(ticket);
+            } else if (!completions->wait_until(ticket, deadline)) {
+                return done();
             }
-            double avg = static_cast<double>(sum) / entry.second.size();
-            std::cout << "Worker " << entry.first << " average waiting time " << avg << " seconds" << std::endl;
         }
+        return true;
+    }
 
-        // блокування для безпечного доступу до статистики часу виконання
-        std::lock_guard<std::mutex> lock2(exec_mtx);
-        if (!queues_execution_times.empty()) {
-            uint64_t sum = 0;
-            for (auto t : queues_execution_times) {
-                sum += t;
+    // відкидання завдань, що ще не почали виконуватися: буфер планувальника, канали й локальні деки
+    // сигнали зупинки (порожні завдання), що вже лежать у каналах, повертаються назад
+    void discard_queued() {
+        size_t dropped = scheduler->discard();
+        for (auto &ch : channels) {
+            std::vector<Job> taken;
+            Job job;
+            size_t stops = 0;
+            while (ch->try_receive(job)) {
+                if (job)
+                    taken.push_back(std::move(job));
+                else
+                    ++stops;
             }
-            double avg = static_cast<double>(sum) / queues_execution_times.size();
-            std::cout << "Average queue execution time: " << avg << " seconds" << std::endl;
+            for (size_t i = 0; i < stops; ++i)
+                ch->send(Job());
+            dropped += taken.size();
+        }
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i)
+            dropped += workers[i]->discard_local();
+        if (dropped > 0)
+            std::cout << "Discarded " << dropped << " queued jobs" << std::endl;
+    }
+
+    // надсилання сигналу зупинки кожному працюючому робітнику в канал його вузла (один раз)
+    // (зайвий сигнал для робітника, що вже зупиняється через простій, нешкідливий)
+    // список складається до відправки: сигнал може забрати інший робітник того ж вузла,
+    // і тоді адресат перестав би вважатися працюючим ще до своєї черги
+    void send_stop_signals() {
+        if (stops_sent)
+            return;
+        stops_sent = true;
+        std::vector<size_t> targets;
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i) {
+            if (workers[i]->is_running())
+                targets.push_back(workers[i]->get_node());
+        }
+        for (size_t node : targets) {
+            channels[node]->send(Job());
+        }
+        wake_workers(targets.size());
+    }
+
+    size_t running_workers() const {
+        size_t running = 0;
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i)
+            running += workers[i]->is_running();
+        return running;
+    }
+
+    LatencySnapshot merge_workers(LatencyHistogram WorkerStats::*metric) const {
+        std::vector<const LatencyHistogram*> parts;
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i)
+            parts.push_back(&(workers[i]->get_stats().*metric));
+        return LatencyHistogram::merge(parts.begin(), parts.end());
+    }
+
+    friend void post_continuation(ThreadPool* pool, Job job);
+    friend JobSlab* strand_detail::slab_of(ThreadPool* pool);
+    friend bool strand_detail::admit(ThreadPool* pool, Job& job, size_t& reserved);
+    friend void strand_detail::release(ThreadPool* pool, size_t reserved);
+    friend void strand_detail::activate(ThreadPool* pool, Job drain);
+    friend void strand_detail::run(ThreadPool* pool, Job& job);
+
+    static Job make_job(Job&& job) {
+        return std::move(job);
+    }
+
+    template <typename F>
+    Job make_job(F&& f) {
+        return Job(std::forward<F>(f), &slab);
+    }
+
+    // у режимі WorkStealing робітники паркуються на group->idle, а не на каналі,
+    // тому після відправки завдань у канал їх треба розбудити явно
+    void wake_workers(uint64_t count) {
+        if (!group || count == 0)
+            return;
+        if (count >= size())
+            group->idle.notify_all();
+        else
+            for (uint64_t i = 0; i < count; ++i)
+                group->idle.notify_one();
+    }
+
+    static void print_snapshot(const char* name, const LatencySnapshot& snap) {
+        if (snap.count == 0)
+            return;
+        std::cout << name << ": " << snap.count << " samples, mean " << snap.mean / 1e3
+                  << " us, p50 " << snap.p50 / 1e3 << " us, p99 " << snap.p99 / 1e3
+                  << " us, p999 " << snap.p999 / 1e3 << " us, max " << snap.max / 1e3 << " us" << std::endl;
+    }
+
+    void print_stats() {
+        std::cout << "Worker waiting times:" << std::endl;
+        // середній час очікування завдання для кожного робітника
+        for (size_t i = 0; i < spawned.load(std::memory_order_acquire); ++i) {
+            LatencySnapshot snap = workers[i]->get_stats().idle_wait.snapshot();
+            if (snap.count == 0)
+                continue;
+            std::cout << "Worker " << workers[i]->get_id() << " average waiting time " << snap.mean / 1e9 << " seconds" << std::endl;
+        }
+
+        LatencyStats latency = latency_stats();
+        if (latency.batch.count > 0)
+            std::cout << "Average queue execution time: " << latency.batch.mean / 1e9 << " seconds" << std::endl;
+        print_snapshot("Queue wait", latency.queue_wait);
+        print_snapshot("Execution", latency.execution);
+        print_snapshot("End-to-end", latency.end_to_end);
+
+        AdmissionStats adm = admission_stats();
+        if (adm.rejected + adm.dropped + adm.caller_runs > 0)
+            std::cout << "Admission: " << adm.accepted << " accepted, " << adm.rejected << " rejected, "
+                      << adm.dropped << " dropped, " << adm.caller_runs << " run by caller, peak buffer "
+                      << adm.peak_jobs << " jobs / " << adm.peak_bytes << " bytes" << std::endl;
+
+        if (elastic.enabled) {
+            ScalingStats st = scaling_stats();
+            std::cout << "Scaling: peak " << st.peak_workers << " workers, " << st.spawned_on_backlog
+                      << " started on backlog, " << st.spawned_on_wait << " started on wait, "
+                      << st.retired << " retired on idle" << std::endl;
+        }
+
+        // середній час очікування в буфері планувальника за класами пріоритету
+        for (size_t p = 0; p < NUM_PRIORITIES; ++p) {
+            PriorityStats st = scheduler->priority_stats(static_cast<Priority>(p));
+            if (st.dispatched == 0)
+                continue;
+            double avg_ms = std::chrono::duration<double, std::milli>(st.total_queue_time).count() / st.dispatched;
+            double max_ms = std::chrono::duration<double, std::milli>(st.max_queue_time).count();
+            std::cout << "Priority " << priority_name(static_cast<Priority>(p)) << ": " << st.dispatched
+                      << " jobs, average queue time " << avg_ms << " ms, max " << max_ms << " ms" << std::endl;
         }
     }
 };
 
+// продовження Future виконується на тому робітнику, що завершив батьківське завдання,
+// минаючи буфер планувальника; поза робітниками пулу — звичайне execute()
+inline void post_continuation(ThreadPool* pool, Job job) {
+    Worker* self = Worker::current();
+    if (self && pool->owns(self)) {
+        pool->submitted.add();
+        self->push_local(std::move(job));
+        return;
+    }
+    pool->execute(std::move(job));
+}
+
+namespace strand_detail {
+
+inline JobSlab* slab_of(ThreadPool* pool) {
+    return &pool->slab;
+}
+
+inline bool admit(ThreadPool* pool, Job& job, size_t& reserved) {
+    pool->submitted.add();
+    if (!pool->scheduler->has_limits())
+        return true;
+    reserved = job.footprint();
+    return pool->scheduler->reserve(reserved);
+}
+
+inline void release(ThreadPool* pool, size_t reserved) {
+    if (reserved)
+        pool->scheduler->release(reserved);
+}
+
+// осушувач іде в локальний дек робітника цього пулу (дані виконавця лишаються в його кеші,
+// а інші робітники можуть перехопити його крадіжкою), інакше — через планувальник повз межі
+// буфера: завдання черги вже пройшли їх у admit()
+inline void activate(ThreadPool* pool, Job drain) {
+    Worker* self = Worker::current();
+    if (self && pool->owns(self)) {
+        self->push_local(std::move(drain));
+        return;
+    }
+    pool->scheduler->schedule_reserved(std::move(drain));
+}
+
+inline void run(ThreadPool* pool, Job& job) {
+    Worker* self = Worker::current();
+    if (self && pool->owns(self)) {
+        self->execute_nested(job);
+        return;
+    }
+    JobFailedScope scope;
+    try {
+        job();
+    } catch (...) {
+        report_job_failure("Strand");
+    }
+}
+
+} // namespace strand_detail
+
 #endif // THREADPOOL_HPP
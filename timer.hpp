@@ -0,0 +1,345 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "job.hpp"
+
+// дескриптор таймера для скасування; після спрацювання одноразового таймера або скасування
+// вузол перевикористовується з новим поколінням, тож застарілий дескриптор нічого не скасує
+struct TimerHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; // 0 — порожній дескриптор
+
+    explicit operator bool() const noexcept {
+        return generation != 0;
+    }
+};
+
+// ієрархічне колесо таймерів: LEVELS рівнів по SLOTS кошиків, кошик рівня L охоплює SLOTS^L тіків
+// таймер лежить на рівні старшої 6-бітної цифри, якою його тік відрізняється від поточного;
+// коли поточний тік доходить до межі рівня, кошик цього рівня переноситься на нижчі ("каскад")
+// вузли таймерів лежать у пулі фіксованого розміру й зв'язані індексами у двобічні списки кошиків,
+// тож додавання і скасування — O(1) без виділення пам'яті (крім росту пулу чанками)
+// не потокобезпечне: синхронізацію забезпечує власник (Scheduler)
+class TimerWheel {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr uint64_t SLOTS = 1ull << SLOT_BITS;
+    static constexpr unsigned LEVELS = 6; // 64^6 тіків по 1 мс — понад 2000 років
+
+    explicit TimerWheel(clock::duration tick = std::chrono::milliseconds(1))
+        : tick(tick)
+        , origin(clock::now())
+    {
+        for (auto &level : heads)
+            for (auto &head : level)
+                head = NONE;
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // таймер спрацює не раніше when (з точністю до тіку); period > 0 — періодичний таймер,
+    // який після кожного виконання треба повернути в колесо через rearm()
+    TimerHandle add(clock::time_point when, Job job, clock::duration period = clock::duration::zero()) {
+        uint32_t index = allocate();
+        Node& node = at(index);
+        node.job = std::move(job);
+        node.due = std::max(current + 1, to_tick_ceil(when));
+        node.period = period > clock::duration::zero() ? std::max<uint64_t>(1, to_ticks_ceil(period)) : 0;
+        node.state = State::Pending;
+        link(index);
+        ++count;
+        return TimerHandle{index, node.generation};
+    }
+
+    // скасування: очікуваний таймер видаляється одразу, періодичний у процесі виконання більше
+    // не повертається в колесо; false, якщо таймер уже спрацював або скасований
+    bool cancel(TimerHandle handle) {
+        Node* node = find(handle);
+        if (!node)
+            return false;
+        if (node->state == State::Pending) {
+            unlink(handle.index);
+            release(handle.index);
+            --count;
+            return true;
+        }
+        if (node->state == State::Running) {
+            node->state = State::Cancelled;
+            return true;
+        }
+        return false;
+    }
+
+    // відкидання всіх таймерів, що очікують: їхні завдання переносяться в out, щоб власник знищив
+    // їх поза своїм м'ютексом; періодичні, що зараз виконуються, більше не повертаються в колесо
+    void clear(std::vector<Job>& out) {
+        for (uint32_t index = 0; index < chunks.size() * CHUNK; ++index) {
+            Node& node = at(index);
+            if (node.state == State::Pending) {
+                out.push_back(std::move(node.job));
+                unlink(index);
+                release(index);
+                --count;
+            } else if (node.state == State::Running) {
+                node.state = State::Cancelled;
+            }
+        }
+    }
+
+    // просування до now: одноразові таймери, що настали, переносяться в expired (вузол звільняється),
+    // періодичні — у periodic (вузол лишається за таймером у стані виконання до rearm())
+    void advance(clock::time_point now, std::vector<Job>& expired, std::vector<TimerHandle>& periodic) {
+        uint64_t target = to_tick_floor(now);
+        while (current < target) {
+            if (count == 0) {
+                current = target;
+                break;
+            }
+            uint64_t next = next_event();
+            if (next > target) {
+                current = target;
+                break;
+            }
+            current = next;
+            // каскад зверху вниз: вузли спускаються на нижчі рівні, а ті, що настали, — у кошик рівня 0
+            for (unsigned level = LEVELS - 1; level > 0; --level) {
+                if ((current & low_mask(level)) == 0)
+                    cascade(level, digit(current, level));
+            }
+            fire(digit(current, 0), expired, periodic);
+        }
+    }
+
+    // завдання періодичного таймера, що зараз виконується (nullptr, якщо дескриптор застарів)
+    // вузол не звільняється до rearm(), тож вказівник дійсний, поки завдання виконується
+    Job* running_job(TimerHandle handle) {
+        Node* node = find(handle);
+        if (!node || (node->state != State::Running && node->state != State::Cancelled))
+            return nullptr;
+        return &node->job;
+    }
+
+    // повернення періодичного таймера в колесо після виконання: наступне спрацювання — через період
+    // від попереднього планового часу (пропущені періоди не наздоганяються); скасований таймер звільняється
+    void rearm(TimerHandle handle) {
+        Node* node = find(handle);
+        if (!node || node->state == State::Pending)
+            return;
+        --running;
+        if (node->state == State::Cancelled) {
+            release(handle.index);
+            --count;
+            return;
+        }
+        node->due = std::max(node->due + node->period, current + 1);
+        node->state = State::Pending;
+        link(handle.index);
+    }
+
+    // час найближчої події колеса (спрацювання або каскаду); clock::time_point::max() без таймерів
+    clock::time_point next_expiry() const {
+        if (pending() == 0)
+            return clock::time_point::max();
+        return origin + tick * static_cast<clock::rep>(next_event());
+    }
+
+    // кількість таймерів (разом із періодичними, що зараз виконуються)
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t CHUNK = 1024; // вузлів в одному чанку пулу
+
+    enum class State : uint8_t {
+        Free,
+        Pending, // лежить у кошику
+        Running, // періодичний таймер спрацював і виконується
+        Cancelled // скасований під час виконання; звільниться в rearm()
+    };
+
+    struct Node {
+        Job job;
+        uint64_t due = 0; // тік спрацювання
+        uint64_t period = 0; // період у тіках (0 — одноразовий)
+        uint32_t prev = NONE;
+        uint32_t next = NONE; // наступний у кошику або у списку вільних
+        uint32_t generation = 1;
+        uint16_t slot = 0; // рівень * SLOTS + кошик
+        State state = State::Free;
+    };
+
+    clock::duration tick;
+    clock::time_point origin; // початок відліку тіків
+    uint64_t current = 0; // останній оброблений тік
+    size_t count = 0;
+    size_t running = 0; // періодичні таймери поза колесом
+    uint32_t heads[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS] = {}; // біт на кожен непорожній кошик рівня
+    std::vector<std::unique_ptr<Node[]>> chunks;
+    uint32_t free_list = NONE;
+
+    static uint64_t low_mask(unsigned level) {
+        return (1ull << (SLOT_BITS * level)) - 1;
+    }
+
+    static uint64_t digit(uint64_t t, unsigned level) {
+        return (t >> (SLOT_BITS * level)) & (SLOTS - 1);
+    }
+
+    uint64_t to_tick_floor(clock::time_point tp) const {
+        return tp > origin ? static_cast<uint64_t>((tp - origin) / tick) : 0;
+    }
+
+    uint64_t to_tick_ceil(clock::time_point tp) const {
+        return tp > origin ? to_ticks_ceil(tp - origin) : 0;
+    }
+
+    uint64_t to_ticks_ceil(clock::duration d) const {
+        return static_cast<uint64_t>((d + tick - clock::duration(1)) / tick);
+    }
+
+    size_t pending() const {
+        return count - running;
+    }
+
+    Node& at(uint32_t index) {
+        return chunks[index / CHUNK][index % CHUNK];
+    }
+
+    Node* find(TimerHandle handle) {
+        if (!handle || handle.index >= chunks.size() * CHUNK)
+            return nullptr;
+        Node& node = at(handle.index);
+        if (node.generation != handle.generation || node.state == State::Free)
+            return nullptr;
+        return &node;
+    }
+
+    uint32_t allocate() {
+        if (free_list == NONE) {
+            uint32_t base = static_cast<uint32_t>(chunks.size() * CHUNK);
+            chunks.emplace_back(new Node[CHUNK]);
+            for (uint32_t i = CHUNK; i-- > 0;) {
+                at(base + i).next = free_list;
+                free_list = base + i;
+            }
+        }
+        uint32_t index = free_list;
+        free_list = at(index).next;
+        return index;
+    }
+
+    void release(uint32_t index) {
+        Node& node = at(index);
+        node.job = Job();
+        node.state = State::Free;
+        // покоління 0 зарезервоване за порожнім дескриптором
+        if (++node.generation == 0)
+            node.generation = 1;
+        node.next = free_list;
+        free_list = index;
+    }
+
+    // кошик таймера: рівень старшої цифри, якою due відрізняється від current
+    void link(uint32_t index) {
+        Node& node = at(index);
+        uint64_t diff = node.due ^ current;
+        unsigned level = 0;
+        while (level + 1 < LEVELS && (diff >> (SLOT_BITS * (level + 1))) != 0)
+            ++level;
+        uint32_t slot = static_cast<uint32_t>(digit(node.due, level));
+        node.slot = static_cast<uint16_t>(level * SLOTS + slot);
+        node.prev = NONE;
+        node.next = heads[level][slot];
+        if (node.next != NONE)
+            at(node.next).prev = index;
+        heads[level][slot] = index;
+        occupied[level] |= 1ull << slot;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = at(index);
+        unsigned level = node.slot / SLOTS;
+        uint32_t slot = node.slot % SLOTS;
+        if (node.prev != NONE)
+            at(node.prev).next = node.next;
+        else
+            heads[level][slot] = node.next;
+        if (node.next != NONE)
+            at(node.next).prev = node.prev;
+        if (heads[level][slot] == NONE)
+            occupied[level] &= ~(1ull << slot);
+    }
+
+    // забирає весь список кошика
+    uint32_t take_slot(unsigned level, uint64_t slot) {
+        uint32_t head = heads[level][slot];
+        heads[level][slot] = NONE;
+        occupied[level] &= ~(1ull << slot);
+        return head;
+    }
+
+    void cascade(unsigned level, uint64_t slot) {
+        for (uint32_t index = take_slot(level, slot); index != NONE;) {
+            uint32_t next = at(index).next;
+            link(index);
+            index = next;
+        }
+    }
+
+    void fire(uint64_t slot, std::vector<Job>& expired, std::vector<TimerHandle>& periodic) {
+        for (uint32_t index = take_slot(0, slot); index != NONE;) {
+            Node& node = at(index);
+            uint32_t next = node.next;
+            if (node.period > 0) {
+                node.state = State::Running;
+                ++running;
+                periodic.push_back(TimerHandle{index, node.generation});
+            } else {
+                expired.push_back(std::move(node.job));
+                release(index);
+                --count;
+            }
+            index = next;
+        }
+    }
+
+    // найближчий тік, на якому щось відбувається: спрацювання на рівні 0 або каскад вищого рівня
+    // вузли рівня L мають цифру L більшу за поточну (при тих самих старших цифрах), тож подією
+    // рівня є найменший зайнятий кошик після поточної цифри; кошик без такого (лише для таймерів
+    // за межами колеса на верхньому рівні) переноситься на наступний оберт рівня
+    uint64_t next_event() const {
+        uint64_t best = UINT64_MAX;
+        for (unsigned level = 0; level < LEVELS; ++level) {
+            if (!occupied[level])
+                continue;
+            uint64_t d = digit(current, level);
+            uint64_t after = d + 1 < SLOTS ? occupied[level] & (~0ull << (d + 1)) : 0;
+            uint64_t base = (current >> (SLOT_BITS * (level + 1))) << (SLOT_BITS * (level + 1));
+            uint64_t candidate;
+            if (after)
+                candidate = base + (static_cast<uint64_t>(__builtin_ctzll(after)) << (SLOT_BITS * level));
+            else
+                candidate = base + (1ull << (SLOT_BITS * (level + 1)));
+            best = std::min(best, candidate);
+        }
+        return best;
+    }
+};
+
+#endif // TIMER_HPP
@@ -0,0 +1,185 @@
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// розміщення робітників по ядрах: None — без прив'язки (планує ОС), Compact — заповнює
+// спершу всі ядра першого вузла NUMA, потім наступного, Scatter — по черзі по одному ядру
+// з кожного вузла
+enum class Placement {
+    None,
+    Compact,
+    Scatter
+};
+
+// розбір списку процесорів у форматі sysfs, наприклад "0-3,8-11"
+inline std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string range = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (range.empty() || range[0] < '0' || range[0] > '9')
+            continue;
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// прив'язка поточного потоку до одного процесора; false, якщо ОС відмовила або платформа не Linux
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// топологія: процесори, доступні процесу, згруповані за вузлами NUMA
+// на машині з одним вузлом (або без /sys/devices/system/node) — один вузол з усіма процесорами;
+// для перевірки розміщення на такій машині топологію можна задати вручну
+// вузли без процесорів не мають сенсу для розміщення й відкидаються (див. drop_empty_nodes())
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes; // процесори кожного вузла
+
+    CpuTopology() = default;
+
+    explicit CpuTopology(std::vector<std::vector<int>> nodes)
+        : nodes(std::move(nodes))
+    {
+        drop_empty_nodes();
+    }
+
+    bool empty() const {
+        return nodes.empty();
+    }
+
+    // nodes можна заповнити й напряму, тож вузли без процесорів відкидаються ще й перед використанням
+    void drop_empty_nodes() {
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(),
+                                   [](const std::vector<int>& cpus) { return cpus.empty(); }),
+                    nodes.end());
+    }
+
+    // читає /sys/devices/system/node/node*/cpulist і відкидає процесори поза маскою
+    // sched_getaffinity (наприклад, обмеження cpuset контейнера)
+    static CpuTopology detect() {
+        CpuTopology topology;
+        std::vector<int> allowed = allowed_cpus();
+#ifdef __linux__
+        std::vector<std::pair<int, std::vector<int>>> found;
+        if (DIR* dir = opendir("/sys/devices/system/node")) {
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.compare(0, 4, "node") != 0 || name.size() == 4 || name[4] < '0' || name[4] > '9')
+                    continue;
+                std::ifstream in("/sys/devices/system/node/" + name + "/cpulist");
+                std::string line;
+                if (!std::getline(in, line))
+                    continue;
+                std::vector<int> cpus;
+                for (int cpu : parse_cpu_list(line))
+                    if (contains(allowed, cpu))
+                        cpus.push_back(cpu);
+                if (!cpus.empty())
+                    found.emplace_back(std::atoi(name.c_str() + 4), std::move(cpus));
+            }
+            closedir(dir);
+        }
+        // readdir не гарантує порядку — упорядковуємо за номером вузла
+        std::sort(found.begin(), found.end());
+        for (auto &node : found)
+            topology.nodes.push_back(std::move(node.second));
+#endif
+        if (topology.nodes.empty())
+            topology.nodes.push_back(allowed);
+        return topology;
+    }
+
+    // порядок заповнення процесорів за політикою: пари (процесор, індекс вузла)
+    // для Placement::None (і для топології без процесорів) процесор дорівнює -1,
+    // а всі робітники належать вузлу 0; індекси вузлів рахуються без порожніх вузлів
+    std::vector<std::pair<int, size_t>> order(Placement placement) const {
+        if (std::any_of(nodes.begin(), nodes.end(), [](const std::vector<int>& cpus) { return cpus.empty(); })) {
+            CpuTopology compact(*this);
+            compact.drop_empty_nodes();
+            return compact.order(placement);
+        }
+        std::vector<std::pair<int, size_t>> result;
+        if (placement == Placement::None || nodes.empty()) {
+            result.emplace_back(-1, 0);
+            return result;
+        }
+        if (placement == Placement::Compact) {
+            for (size_t node = 0; node < nodes.size(); ++node)
+                for (int cpu : nodes[node])
+                    result.emplace_back(cpu, node);
+            return result;
+        }
+        for (size_t i = 0; ; ++i) {
+            bool any = false;
+            for (size_t node = 0; node < nodes.size(); ++node) {
+                if (i < nodes[node].size()) {
+                    result.emplace_back(nodes[node][i], node);
+                    any = true;
+                }
+            }
+            if (!any)
+                break;
+        }
+        return result;
+    }
+
+private:
+    static bool contains(const std::vector<int>& cpus, int cpu) {
+        for (int c : cpus)
+            if (c == cpu)
+                return true;
+        return false;
+    }
+
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+        }
+#endif
+        if (cpus.empty()) {
+            unsigned count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned cpu = 0; cpu < count; ++cpu)
+                cpus.push_back(static_cast<int>(cpu));
+        }
+        return cpus;
+    }
+};
+
+#endif // TOPOLOGY_HPP
@@ -0,0 +1,337 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// трасування подій пулу у формат Chrome trace-event JSON (відкривається в chrome://tracing і Perfetto)
+// під час компіляції: -DTHREADPOOL_TRACING=0 прибирає всі точки трасування (макроси стають порожніми)
+// під час виконання: trace::Tracer::instance().start("trace.json") / stop(); поки трасування
+// не запущене, точка трасування — одне relaxed-читання прапорця
+#ifndef THREADPOOL_TRACING
+#define THREADPOOL_TRACING 1
+#endif
+
+namespace trace {
+
+enum class EventType : uint8_t {
+    Enqueue, // завдання надійшли в буфер планувальника (arg — кількість)
+    Flush, // планувальник переніс завдання в канал (arg — кількість)
+    Dequeue, // робітник забрав завдання з каналу
+    Start, // початок виконання завдання
+    End, // кінець виконання завдання
+    Steal, // робітник вкрав завдання (arg — номер жертви)
+    Park, // потік засинає в очікуванні роботи
+    Unpark // потік прокинувся
+};
+
+// бінарна подія в буфері потоку
+struct Event {
+    uint64_t time; // наносекунди steady_clock
+    uint32_t arg;
+    EventType type;
+};
+
+// кільцевий буфер подій одного потоку: пише лише власник, читає лише потік вивантаження (SPSC)
+// якщо буфер повний, подія відкидається і враховується в dropped
+class ThreadBuffer {
+public:
+    static constexpr size_t CAPACITY = 8192;
+
+    ThreadBuffer(uint32_t tid, std::string name)
+        : tid(tid)
+        , name(std::move(name))
+        , events(CAPACITY)
+    {
+    }
+
+    void push(EventType type, uint32_t arg) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        events[h % CAPACITY] = Event{static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()), arg, type};
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // переносить накопичені події в out; викликається лише потоком вивантаження
+    void drain(std::vector<Event>& out) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        uint64_t h = head.load(std::memory_order_acquire);
+        for (; t != h; ++t)
+            out.push_back(events[t % CAPACITY]);
+        tail.store(t, std::memory_order_release);
+    }
+
+    const uint32_t tid;
+    std::string name; // змінюється під м'ютексом Tracer
+    bool named = false; // метадані з назвою потоку вже записані (змінюється під м'ютексом Tracer)
+    std::atomic<bool> alive{true}; // потік-власник ще існує
+    std::atomic<uint64_t> dropped{0};
+
+private:
+    std::vector<Event> events;
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+// глобальний трасувальник: реєстр буферів потоків і потік асинхронного вивантаження у файл
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    // чи запущене трасування (перевіряється в кожній точці трасування)
+    static bool active() {
+        return enabled_flag().load(std::memory_order_relaxed);
+    }
+
+    // запуск трасування у файл path; false, якщо трасування вимкнене під час компіляції,
+    // уже запущене або файл не вдалося відкрити
+    bool start(const std::string& path, std::chrono::milliseconds drain_interval = std::chrono::milliseconds(10)) {
+#if THREADPOOL_TRACING
+        std::lock_guard<std::mutex> lock(mtx);
+        if (running)
+            return false;
+        out.open(path);
+        if (!out)
+            return false;
+        out << "{\"traceEvents\":[\n";
+        first = true;
+        origin = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        running = true;
+        drainer = std::thread([this, drain_interval]() { run_drainer(drain_interval); });
+        enabled_flag().store(true, std::memory_order_relaxed);
+        return true;
+#else
+        (void)path;
+        (void)drain_interval;
+        return false;
+#endif
+    }
+
+    // зупинка: останнє вивантаження і закриття файлу
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running)
+                return;
+            enabled_flag().store(false, std::memory_order_relaxed);
+            running = false;
+        }
+        wake.notify_all();
+        drainer.join();
+        drain_all();
+        out << "\n]}\n";
+        out.close();
+    }
+
+    // запис події поточного потоку; буфер створюється під час першої події потоку
+    void record(EventType type, uint32_t arg) {
+        ThreadBuffer* buffer = local().buffer.get();
+        if (!buffer)
+            buffer = register_thread();
+        buffer->push(type, arg);
+    }
+
+    // назва поточного потоку в трасі (наприклад, "worker 3")
+    void set_thread_name(const std::string& name) {
+        thread_name() = name;
+        if (auto &buffer = local().buffer) {
+            std::lock_guard<std::mutex> lock(mtx);
+            buffer->name = name;
+            buffer->named = false;
+        }
+    }
+
+    // кількість подій, відкинутих через переповнення буферів
+    uint64_t dropped_events() {
+        std::lock_guard<std::mutex> lock(mtx);
+        uint64_t total = retired_dropped;
+        for (auto &buffer : buffers)
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    // власник буфера в thread_local: після завершення потоку буфер позначається мертвим
+    // і видаляється з реєстру після останнього вивантаження
+    struct LocalBuffer {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        ~LocalBuffer() {
+            if (buffer)
+                buffer->alive.store(false, std::memory_order_release);
+        }
+    };
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint64_t retired_dropped = 0;
+    uint32_t next_tid = 1;
+    bool running = false;
+    std::thread drainer;
+    std::ofstream out; // пише лише потік вивантаження, а після його зупинки — stop()
+    bool first = true;
+    uint64_t origin = 0;
+    std::vector<Event> scratch;
+
+    Tracer() = default;
+
+    ~Tracer() {
+        stop();
+    }
+
+    static std::atomic<bool>& enabled_flag() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    static LocalBuffer& local() {
+        thread_local LocalBuffer buffer;
+        return buffer;
+    }
+
+    static std::string& thread_name() {
+        thread_local std::string name;
+        return name;
+    }
+
+    ThreadBuffer* register_thread() {
+        std::lock_guard<std::mutex> lock(mtx);
+        uint32_t tid = next_tid++;
+        std::string name = thread_name().empty() ? "thread " + std::to_string(tid) : thread_name();
+        auto buffer = std::make_shared<ThreadBuffer>(tid, std::move(name));
+        buffers.push_back(buffer);
+        local().buffer = buffer;
+        return buffer.get();
+    }
+
+    void run_drainer(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (running) {
+            wake.wait_for(lock, interval);
+            lock.unlock();
+            drain_all();
+            lock.lock();
+        }
+    }
+
+    // вивантаження всіх буферів у файл; буфери завершених потоків видаляються
+    void drain_all() {
+        std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            snapshot = buffers;
+        }
+        for (auto &buffer : snapshot) {
+            bool dead = !buffer->alive.load(std::memory_order_acquire);
+            scratch.clear();
+            buffer->drain(scratch);
+            write_events(*buffer, scratch);
+            if (dead)
+                forget(buffer);
+        }
+        out.flush();
+    }
+
+    void forget(const std::shared_ptr<ThreadBuffer>& buffer) {
+        std::lock_guard<std::mutex> lock(mtx);
+        retired_dropped += buffer->dropped.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            if (buffers[i] == buffer) {
+                buffers.erase(buffers.begin() + i);
+                break;
+            }
+        }
+    }
+
+    void write_events(ThreadBuffer& buffer, const std::vector<Event>& events) {
+        if (events.empty())
+            return;
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!buffer.named)
+                name = buffer.name;
+            buffer.named = true;
+        }
+        if (!name.empty()) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.tid
+                << ",\"args\":{\"name\":\"" << name << "\"}}";
+        }
+        for (const auto &event : events) {
+            separator();
+            double ts = event.time > origin ? static_cast<double>(event.time - origin) / 1000.0 : 0.0;
+            out << "{\"name\":\"" << event_name(event.type) << "\",\"ph\":\"" << phase(event.type)
+                << "\",\"pid\":1,\"tid\":" << buffer.tid << ",\"ts\":" << std::fixed << ts;
+            if (phase(event.type)[0] == 'i')
+                out << ",\"s\":\"t\",\"args\":{\"n\":" << event.arg << "}";
+            out << "}";
+        }
+    }
+
+    void separator() {
+        if (!first)
+            out << ",\n";
+        first = false;
+    }
+
+    // Start/End і Park/Unpark — парні відрізки (B/E), решта — миттєві події
+    static const char* phase(EventType type) {
+        switch (type) {
+            case EventType::Start:
+            case EventType::Park:
+                return "B";
+            case EventType::End:
+            case EventType::Unpark:
+                return "E";
+            default:
+                return "i";
+        }
+    }
+
+    static const char* event_name(EventType type) {
+        switch (type) {
+            case EventType::Enqueue: return "enqueue";
+            case EventType::Flush: return "flush";
+            case EventType::Dequeue: return "dequeue";
+            case EventType::Start:
+            case EventType::End: return "job";
+            case EventType::Steal: return "steal";
+            case EventType::Park:
+            case EventType::Unpark: return "park";
+        }
+        return "unknown";
+    }
+};
+
+} // namespace trace
+
+#if THREADPOOL_TRACING
+#define TRACE_EVENT(type, arg) \
+    do { \
+        if (trace::Tracer::active()) \
+            trace::Tracer::instance().record(trace::EventType::type, static_cast<uint32_t>(arg)); \
+    } while (0)
+#define TRACE_THREAD_NAME(name) trace::Tracer::instance().set_thread_name(name)
+#else
+#define TRACE_EVENT(type, arg) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // TRACE_HPP
@@ -0,0 +1,137 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "cpu.hpp"
+
+// дек Чейза-Ліва: власник додає і забирає елементи з низу (LIFO) без блокувань,
+// інші потоки крадуть з верху (FIFO) через CAS по top
+// T має бути тривіально копійованим (на практиці — вказівник), бо злодій читає
+// елемент до того, як CAS підтвердить, що він йому належить
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque stores trivially copyable values");
+
+public:
+    explicit WorkStealingDeque(size_t capacity = 256)
+        : top(0)
+        , bottom(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        arrays.emplace_back(new Array(size));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // додавання елемента власником; при переповненні масив подвоюється
+    void push(T item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->size) - 1) {
+            a = grow(a, b, t);
+        }
+        a->put(b, item);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // забирання останнього доданого елемента власником (LIFO)
+    bool pop(T& out) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // дек порожній
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = a->get(b);
+        if (t == b) {
+            // останній елемент — змагаємося зі злодіями
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // крадіжка найстарішого елемента іншим потоком (FIFO)
+    bool steal(T& out) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return false;
+
+        Array* a = array.load(std::memory_order_acquire);
+        T item = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false; // інший злодій або власник встиг раніше
+        out = item;
+        return true;
+    }
+
+    // приблизна кількість елементів
+    size_t size() const {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    bool is_empty() const {
+        return size() == 0;
+    }
+
+private:
+    struct Array {
+        size_t size;
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Array(size_t size)
+            : size(size)
+            , mask(size - 1)
+            , items(new std::atomic<T>[size])
+        {
+        }
+
+        T get(int64_t i) const {
+            return items[static_cast<size_t>(i) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t i, T item) {
+            items[static_cast<size_t>(i) & mask].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top;
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom;
+    alignas(CACHE_LINE_SIZE) std::atomic<Array*> array;
+    // старі масиви живуть до знищення деку, бо злодії ще можуть їх читати
+    std::vector<std::unique_ptr<Array>> arrays;
+
+    Array* grow(Array* old, int64_t b, int64_t t) {
+        Array* bigger = new Array(old->size * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        arrays.emplace_back(bigger);
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+#endif // WORK_STEALING_DEQUE_HPP
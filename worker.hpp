@@ -1,25 +1,109 @@
 #ifndef WORKER_HPP
 #define WORKER_HPP
 
+#include <algorithm>
 #include <thread>
 #include <functional>
 #include <chrono>
+#include <exception>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 #include "channel.hpp"
+#include "event_count.hpp"
+#include "histogram.hpp"
+#include "job.hpp"
+#include "topology.hpp"
+#include "trace.hpp"
+#include "work_stealing_deque.hpp"
 
-// тип Job як функція без параметрів, що повертає void
-using Job = std::function<void()>;
+class Worker;
 
-// конструктор класу Worker, що приймає: id, channel, backChannel
-// worker надсилає інформацію про час очікування завдання через спільний вказівник на канал для зворотного зв'язку
+// спільний стан робітників у режимі work-stealing:
+// таблиця локальних деків (для крадіжок) та eventcount для паркування бездіяльних робітників
+struct WorkerGroup {
+    explicit WorkerGroup(size_t size)
+        : deques(size)
+    {
+        for (auto &slot : deques)
+            slot.store(nullptr, std::memory_order_relaxed);
+    }
+
+    std::vector<std::atomic<WorkStealingDeque<Job*>*>> deques;
+    EventCount idle;
+};
+
+// статистика одного робітника: гістограми з наносекундною роздільністю та лічильники подій
+// пише лише потік робітника, читають будь-які потоки без блокувань
+// лічильники займають власну кеш-лінію в кінці структури, тож не ділять її з чужими даними
+struct WorkerStats {
+    LatencyHistogram idle_wait; // скільки робітник чекав на нове завдання
+    LatencyHistogram queue_wait; // від надходження завдання в пул до початку виконання
+    LatencyHistogram execution; // час виконання завдання
+    LatencyHistogram end_to_end; // від надходження в пул до завершення
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> completed{0}; // завершені завдання з каналу (їх рахує планувальник)
+    std::atomic<uint64_t> failed{0}; // завдання, що завершилися винятком
+    std::atomic<uint64_t> steals{0}; // завдання з деків інших робітників або каналів інших вузлів
+    std::atomic<uint64_t> parks{0}; // засинання без роботи
+
+    // збільшення лічильника потоком-власником: load + store без RMW
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// виняток, що вийшов із завдання, виводиться так само, як решта діагностики пулу
+// (викликається з блоку catch)
+inline void report_job_failure(const std::string& who) {
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        std::cout << who << ": job failed with exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cout << who << ": job failed with unknown exception" << std::endl;
+    }
+}
+
+// розміщення робітника: процесор для прив'язки (-1 — без прив'язки), вузол NUMA
+// та канали інших вузлів, з яких робітник забирає завдання, лише коли його власний канал порожній
+// wakeup — спільний сигнал відправок у всі канали пулу (режим SharedQueue з кількома вузлами):
+// на ньому робітник паркується замість власного каналу, тож прокидається і на завдання інших вузлів
+struct WorkerPlacement {
+    int cpu = -1;
+    size_t node = 0;
+    std::vector<std::shared_ptr<Channel<Job>>> remote;
+    std::shared_ptr<EventCount> wakeup;
+};
+
+// конструктор класу Worker, що приймає: id, channel, completions
+// після кожного завдання з каналу worker збільшує свій лічильник completed і будить того,
+// хто чекає на completions (потік планувальника), замість окремого повідомлення в канал статистики
+// якщо передано group, worker працює в режимі work-stealing: має власний дек для завдань,
+// створених усередині завдань, і краде з деків інших робітників, коли його дек і канал порожні
+// вузли локального деку беруться зі slab (спільного для всіх робітників пулу, бо вкрадене завдання
+// звільняє злодій); без slab — з купи
 class Worker {
 public:
     Worker(size_t id,
            std::shared_ptr<Channel<Job>> channel,
-           std::shared_ptr<Channel<std::pair<size_t, uint64_t>>> backChannel)
-        : id(id), channel(channel), backChannel(backChannel), thread(&Worker::run, this)
+           std::shared_ptr<EventCount> completions,
+           std::shared_ptr<WorkerGroup> group = nullptr,
+           std::function<void()> on_idle = nullptr,
+           WorkerPlacement placement = WorkerPlacement(),
+           JobSlab* slab = nullptr)
+        : id(id), channel(channel), completions(completions), group(group), on_idle(std::move(on_idle))
+        , placement(std::move(placement)), slab(slab), rng_state(id * 0x9E3779B97F4A7C15ull + 1)
     {
+        if (group)
+            group->deques[id].store(&local, std::memory_order_release);
+        start();
+    }
+
+    ~Worker() {
+        Job* job;
+        while (local.pop(job))
+            free_node(job);
     }
 
     // метод join(), дозволяє основному потоку чекати завершення роботи цього worker'а
@@ -34,35 +118,392 @@ public:
             thread.detach();
     }
 
+    // повторний запуск worker'а, що вже отримав сигнал зупинки (еластичний пул):
+    // об'єкт, його дек і статистика зберігаються, створюється лише новий потік
+    void restart() {
+        join();
+        start();
+    }
+
+    // чи працює потік worker'а (false після отримання порожнього завдання)
+    bool is_running() const {
+        return running.load(std::memory_order_acquire);
+    }
+
+    // з якого моменту worker чекає на роботу (time_since_epoch steady_clock); 0 — зайнятий
+    std::chrono::steady_clock::rep idle_since() const {
+        return idle_from.load(std::memory_order_relaxed);
+    }
+
+    // worker, у потоці якого виконується поточний код (nullptr поза робітниками)
+    static Worker* current() {
+        return current_worker();
+    }
+
+    // чи належить worker до вказаної групи work-stealing
+    bool belongs_to(const WorkerGroup* g) const {
+        return group && group.get() == g;
+    }
+
+    size_t get_id() const {
+        return id;
+    }
+
+    size_t get_node() const {
+        return placement.node;
+    }
+
+    const WorkerStats& get_stats() const {
+        return stats;
+    }
+
+    // чи читає worker завдання з цього каналу (тобто чи належить він тому самому пулу)
+    bool serves(const Channel<Job>* ch) const {
+        return channel.get() == ch;
+    }
+
+    // відкидає завдання локального деку, що ще не почали виконуватися (зупинка пулу без виконання черги)
+    // безпечно з будь-якого потоку: завдання забираються так само, як під час крадіжки
+    size_t discard_local() {
+        size_t discarded = 0;
+        for (size_t n = local.size(); n > 0; --n) {
+            Job* job = nullptr;
+            if (local.steal(job)) {
+                free_node(job);
+                ++discarded;
+            }
+        }
+        return discarded;
+    }
+
+    // додає завдання до локального деку; у режимі work-stealing будить одного бездіяльного робітника,
+    // який зможе його вкрасти, а у звичайному режимі worker виконає його сам одразу після поточного завдання
+    // викликається лише з потоку цього worker'а
+    void push_local(Job job) {
+        job.set_submit_time(std::chrono::steady_clock::now());
+        local.push(make_node(std::move(job)));
+        if (group)
+            group->idle.notify_one();
+    }
+
+    // завдання, яке виконується всередині поточного на цьому робітнику (завдання Strand у його осушувачі),
+    // зараховується як окреме, а поточне стає обгорткою
+    void execute_nested(Job& job) {
+        execute(job, std::chrono::steady_clock::now());
+        wrapper = true;
+    }
+
 private:
     size_t id; // унікальний ідентифікатор worker'а
     std::shared_ptr<Channel<Job>> channel; // спільний вказівник на канал завдань
-    std::shared_ptr<Channel<std::pair<size_t, uint64_t>>> backChannel; // канал для зворотного зв'язку (id, час очікування)
+    std::shared_ptr<EventCount> completions; // сигнал про завершення завдання з каналу
+    WorkerStats stats; // гістограми затримок і лічильник завершень
+    std::shared_ptr<WorkerGroup> group; // спільний стан режиму work-stealing (nullptr у звичайному режимі)
+    std::function<void()> on_idle; // викликається, коли канал порожній і worker ось-ось засне
+    WorkerPlacement placement; // процесор, вузол NUMA і канали інших вузлів
+    JobSlab* slab; // пам'ять вузлів локального деку (nullptr — купа)
+    WorkStealingDeque<Job*> local; // локальний дек завдань, створених цим worker'ом
+    uint64_t rng_state; // стан генератора для вибору жертви крадіжки
+    unsigned spin_limit = 64; // адаптивний ліміт спіну перед паркуванням (режим work-stealing)
+    static constexpr unsigned MIN_SPIN = 16;
+    static constexpr unsigned MAX_SPIN = 1024;
+    // скільки продовжень з локального деку робітник SharedQueue виконує поспіль, перш ніж
+    // зарахувати завдання каналу й перевірити канал (інакше ланцюжок продовжень, що ставить
+    // наступні, як осушувач Strand, займав би робітника без кінця)
+    static constexpr size_t LOCAL_BATCH = 16;
+    std::atomic<bool> running{false}; // потік запущено і він ще не отримав сигнал зупинки
+    std::atomic<std::chrono::steady_clock::rep> idle_from{0}; // початок поточного простою (0 — зайнятий)
+    bool wrapper = false; // поточне завдання виконало інші через execute_nested()
     std::thread thread; // потік, в якому працює worker
 
+    void start() {
+        running.store(true, std::memory_order_release);
+        thread = std::thread([this]() {
+            run();
+            idle_from.store(0, std::memory_order_relaxed);
+            running.store(false, std::memory_order_release);
+            // пул, що зупиняється, чекає на завершення робітників через той самий сигнал
+            completions->notify_all();
+        });
+    }
+
+    void mark_idle(std::chrono::steady_clock::time_point since) {
+        idle_from.store(since.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    void mark_busy() {
+        idle_from.store(0, std::memory_order_relaxed);
+    }
+
+    static Worker*& current_worker() {
+        thread_local Worker* worker = nullptr;
+        return worker;
+    }
+
     // метод run() отримує завдання з каналу, вимірює час очікування, виконує завдання
-    // потім надсилає статистику (ідентифікатор і час очікування) через backChannel
+    // і записує затримки у власні гістограми
     void run() {
+        current_worker() = this;
+        TRACE_THREAD_NAME("worker " + std::to_string(id));
+        if (placement.cpu >= 0)
+            pin_current_thread(placement.cpu);
+        if (group) {
+            run_stealing();
+            return;
+        }
+
         while (true) {
             auto start_time = std::chrono::steady_clock::now();
 
-            // отримання завдання з каналу (блокується, якщо черга порожня)
-            Job job = channel->receive();
-            auto wait_time = std::chrono::duration_cast<std::chrono::seconds>(
-                std::chrono::steady_clock::now() - start_time).count();
+            // отримання завдання з каналу (блокується, якщо черга порожня); продовження,
+            // що лишилися в локальному деку, чергуються із завданнями каналу
+            Job job;
+            bool found = channel->try_receive(job);
+            if (!found && run_local())
+                continue;
+            if (!found && !steal_remote(job)) {
+                mark_idle(start_time);
+                if (on_idle)
+                    on_idle();
+                WorkerStats::bump(stats.parks);
+                TRACE_EVENT(Park, id);
+                job = placement.wakeup ? wait_any() : channel->receive();
+                TRACE_EVENT(Unpark, id);
+                mark_busy();
+            }
+            auto received = std::chrono::steady_clock::now();
+            stats.idle_wait.record(received - start_time);
 
             // якщо отримане завдання порожнє -> зупинка роботи worker'а
+            // (продовження, що лишилися, виконуються до зупинки; режими без доробки черги вже відкинули їх)
             if (!job) {
+                while (run_local()) {}
                 std::cout << "Worker " << id << " was told to stop." << std::endl;
                 break;
             }
 
-            std::cout << "Worker " << id << " got a job; executing." << std::endl;
-            job();
+            TRACE_EVENT(Dequeue, id);
+            execute(job, received);
+
+            // продовження, поставлені завданням у локальний дек (наприклад, Future::then)
+            run_local();
+
+            complete();
+        }
+    }
+
+    // цикл режиму work-stealing: спершу власний дек (LIFO), потім глобальний канал,
+    // потім крадіжка з випадкових жертв (FIFO); якщо роботи немає — паркування на group->idle
+    // лічильник completed збільшують лише завдання з глобального каналу, бо лише їх рахує планувальник
+    void run_stealing() {
+        auto start_time = std::chrono::steady_clock::now();
+        bool idle = false;
+        unsigned spins = 0;
+        while (true) {
+            Job* spawned = nullptr;
+            if (local.pop(spawned) || steal(spawned)) {
+                if (idle) {
+                    mark_busy();
+                    idle = false;
+                }
+                found_work(spins);
+                run_spawned(spawned);
+                continue;
+            }
+
+            Job job;
+            if (channel->try_receive(job) || steal_remote(job)) {
+                if (idle) {
+                    mark_busy();
+                    idle = false;
+                }
+                found_work(spins);
+                auto received = std::chrono::steady_clock::now();
+                stats.idle_wait.record(received - start_time);
+
+                if (!job) {
+                    std::cout << "Worker " << id << " was told to stop." << std::endl;
+                    break;
+                }
+
+                TRACE_EVENT(Dequeue, id);
+                execute(job, received);
+                complete();
+                start_time = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            // короткий адаптивний спін перед паркуванням: робота часто з'являється за мікросекунди
+            if (spins < spin_limit) {
+                spin_backoff(spins++);
+                continue;
+            }
+            spin_limit = std::max(MIN_SPIN, spin_limit / 2);
+            spins = 0;
 
-            backChannel->send(std::make_pair(id, static_cast<uint64_t>(wait_time)));
+            // повторна перевірка після реєстрації як сплячого, щоб не пропустити notify
+            uint64_t ticket = group->idle.prepare_wait();
+            if (!channel->is_empty() || has_victim_work()) {
+                group->idle.cancel_wait();
+                continue;
+            }
+            if (!idle) {
+                mark_idle(std::chrono::steady_clock::now());
+                idle = true;
+            }
+            if (on_idle)
+                on_idle();
+            WorkerStats::bump(stats.parks);
+            TRACE_EVENT(Park, id);
+            group->idle.wait(ticket);
+            TRACE_EVENT(Unpark, id);
         }
     }
+
+    // робота знайшлася під час спіну — наступного разу варто крутитися довше
+    void found_work(unsigned& spins) {
+        if (spins > 0 && spin_limit < MAX_SPIN)
+            spin_limit += spin_limit / 8 + 1;
+        spins = 0;
+    }
+
+    // не більше LOCAL_BATCH продовжень з локального деку; false — дек порожній
+    bool run_local() {
+        Job* spawned = nullptr;
+        size_t done = 0;
+        while (done < LOCAL_BATCH && local.pop(spawned)) {
+            run_spawned(spawned);
+            ++done;
+        }
+        return done > 0;
+    }
+
+    void run_spawned(Job* job) {
+        struct Owned {
+            Worker* self;
+            Job* job;
+            ~Owned() { self->free_node(job); }
+        } owned{this, job};
+        execute(*job, std::chrono::steady_clock::now());
+    }
+
+    Job* make_node(Job&& job) {
+        void* memory = slab ? slab->allocate(sizeof(Job)) : ::operator new(sizeof(Job));
+        return new (memory) Job(std::move(job));
+    }
+
+    void free_node(Job* job) noexcept {
+        job->~Job();
+        if (slab)
+            slab->deallocate(job, sizeof(Job));
+        else
+            ::operator delete(job);
+    }
+
+    // виконання завдання із записом часу в черзі, часу виконання та наскрізної затримки
+    // виняток, що вийшов із завдання, виводиться, зараховується в failed і не зупиняє робітника
+    // завдання-обгортка, що виконало інші через execute_nested(), у статистику не потрапляє
+    void execute(Job& job, std::chrono::steady_clock::time_point started) {
+        TRACE_EVENT(Start, id);
+        wrapper = false;
+        bool failed;
+        {
+            JobFailedScope scope;
+            try {
+                job();
+            } catch (...) {
+                report_job_failure("Worker " + std::to_string(id));
+                job_failed_flag() = true;
+            }
+            failed = job_failed_flag();
+        }
+        TRACE_EVENT(End, id);
+        if (wrapper)
+            return;
+        if (job.has_submit_time())
+            stats.queue_wait.record(started - job.submit_time());
+        if (failed)
+            WorkerStats::bump(stats.failed);
+        auto finished = std::chrono::steady_clock::now();
+        stats.execution.record(finished - started);
+        if (job.has_submit_time())
+            stats.end_to_end.record(finished - job.submit_time());
+    }
+
+    // облік завершеного завдання з каналу; пише лише цей потік, тому досить load + store
+    void complete() {
+        stats.completed.store(stats.completed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        completions->notify_all();
+    }
+
+    // очікування на спільному сигналі каналів: власний канал, потім канали інших вузлів
+    Job wait_any() {
+        Job job;
+        while (true) {
+            uint64_t ticket = placement.wakeup->prepare_wait();
+            if (channel->try_receive(job) || steal_remote(job)) {
+                placement.wakeup->cancel_wait();
+                return job;
+            }
+            placement.wakeup->wait(ticket);
+        }
+    }
+
+    // завдання з каналу іншого вузла NUMA; викликається лише тоді, коли власний канал порожній
+    // порожнє завдання (сигнал зупинки) адресоване робітникам того вузла, тож повертається назад
+    bool steal_remote(Job& out) {
+        for (auto &ch : placement.remote) {
+            if (!ch->try_receive(out))
+                continue;
+            if (out) {
+                WorkerStats::bump(stats.steals);
+                return true;
+            }
+            ch->send(Job());
+            if (group)
+                group->idle.notify_all();
+            if (placement.wakeup)
+                placement.wakeup->notify_all();
+        }
+        return false;
+    }
+
+    // спроба вкрасти завдання: обходимо всіх інших робітників, починаючи з випадкового
+    bool steal(Job*& out) {
+        size_t n = group->deques.size();
+        if (n < 2)
+            return false;
+        size_t start = static_cast<size_t>(next_random() % n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t victim = (start + i) % n;
+            if (victim == id)
+                continue;
+            WorkStealingDeque<Job*>* deque = group->deques[victim].load(std::memory_order_acquire);
+            if (deque && deque->steal(out)) {
+                WorkerStats::bump(stats.steals);
+                TRACE_EVENT(Steal, victim);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool has_victim_work() const {
+        for (const auto &slot : group->deques) {
+            WorkStealingDeque<Job*>* deque = slot.load(std::memory_order_acquire);
+            if (deque && !deque->is_empty())
+                return true;
+        }
+        return false;
+    }
+
+    // xorshift64: дешевий генератор для вибору жертви
+    uint64_t next_random() {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        return rng_state;
+    }
 };
 
 #endif // WORKER_HPP